@@ -1,17 +1,49 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
 #include "src/core/game.h"
+#include "src/world/worldgen_bench.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+    bool benchRenderDistance = false;
+    bool benchCaves = false;
+    SaveMode saveMode = SAVE_REGION;
+    WorldGenSettings genSettings;
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--bench-render-distance") == 0)
+            benchRenderDistance = true;
+        else if(strcmp(argv[i], "--bench-caves") == 0)
+            benchCaves = true;
+        else if(strcmp(argv[i], "--delta-save") == 0)
+            saveMode = SAVE_DELTA;      // 只保存编辑记录
+        else if(strcmp(argv[i], "--cave-lattice") == 0 && i + 2 < argc)
+        {
+            // 洞穴密度的格点间隔（水平、垂直）
+            genSettings.set_cave_lattice(atoi(argv[i + 1]), atoi(argv[i + 2]));
+            i += 2;
+        }
+        else if(strcmp(argv[i], "--climate-cell") == 0 && i + 1 < argc)
+            genSettings.set_climate_cell(atoi(argv[++i]));  // 气候噪声的格点间隔
+    }
+
+    // 洞穴格点插值基准只生成区块数据，不创建窗口
+    if(benchCaves)
+    {
+        benchmark_cave_lattice(114514, 8);
+        return 0;
+    }
+
     glfwInit(); // 初始化GLFW
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); //使用核心模式
 
     bool gameInitStatus = true;
-    Game game(gameInitStatus, 114514);  // 记录游戏中的所有状态和信息
+    Game game(gameInitStatus, 114514, saveMode, genSettings);  // 记录游戏中的所有状态和信息
     if(!gameInitStatus)
     {
         cout << "game init failed" << endl;
@@ -21,7 +53,10 @@ int main()
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     glEnable(GL_DEPTH_TEST);
 
-    game.game_loop();
+    if(benchRenderDistance)
+        game.benchmark_render_distance();
+    else
+        game.game_loop();
 
     game.clear();
 
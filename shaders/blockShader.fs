@@ -1,6 +1,8 @@
 #version 450 core
 
 in vec2 TexCoords;
+flat in vec2 TileOrigin;
+in vec2 TileRepeat;
 in float SkyLight;     // 顶点着色器已解码的天空光 0~15
 in float BlockLight;   // 顶点着色器已解码的方块光 0~15
 in float FragDist;
@@ -20,7 +22,13 @@ void main()
     vec4 texColor;
     switch(textureUsed)
     {
-        case(0):{texColor = texture(blockTexture, TexCoords); break;}
+        case(0):
+        {
+            // 在单个图集格子内重复采样（图集为 GL_NEAREST 且无 mipmap，fract 的不连续不会产生接缝）
+            vec2 atlasUV = TileOrigin + vec2(fract(TileRepeat.x), -fract(TileRepeat.y)) / 16.0;
+            texColor = texture(blockTexture, atlasUV);
+            break;
+        }
         case(1):{texColor = texture(playerTexture, TexCoords); break;}
         default:{texColor = vec4(0.5f);}
     }
@@ -3,27 +3,55 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in float aLightLevel;  // 编码光照：sky + block/16
+layout (location = 4) in uvec2 aPacked;      // 地形打包顶点（TerrainVertex），仅 textureUsed == 0 时使用
+layout (location = 5) in vec3 aChunkOrigin;  // 地形区块原点（逐实例属性，由绘制命令的 baseInstance 选取）
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 uniform vec3 viewPos;
+uniform int textureUsed;   // 0 = 地形（TerrainVertex），1 = 玩家（Vertex）
 
 out vec2 TexCoords;
+flat out vec2 TileOrigin;  // 地形：图集格子左上角
+out vec2 TileRepeat;       // 地形：格内重复坐标（合并面片跨多个格子）
 out float SkyLight;    // 解码后的天空光 0~15
 out float BlockLight;  // 解码后的方块光 0~15
 out float FragDist;
 
 void main()
 {
-    vec4 worldPos = model * vec4(aPos, 1.0);
-    gl_Position = projection * view * worldPos;
-    TexCoords = aTexCoords;
+    vec3 position;
+    if(textureUsed == 0)
+    {
+        // lo: x(6) | y(8) | z(6) | face(3) | light(8)
+        uint lo = aPacked.x;
+        position = vec3(float(lo & 63u), float((lo >> 6) & 255u), float((lo >> 14) & 63u)) + aChunkOrigin;
+        uint light = lo >> 23;
+        SkyLight   = float(light >> 4);
+        BlockLight = float(light & 15u);
+
+        // hi: tile(8) | u(6) | v(6)，tile = 行 * 16 + 列，(u, v) 为格内重复坐标 ∈ [0, 32]
+        uint hi = aPacked.y;
+        uint tile = hi & 255u;
+        TileOrigin = vec2(float(tile & 15u), 16.0 - float(tile >> 4)) / 16.0;
+        TileRepeat = vec2(float((hi >> 8) & 63u), float((hi >> 14) & 63u));
+        TexCoords = vec2(0.0);
+    }
+    else
+    {
+        position = aPos;
+        TexCoords = aTexCoords;
+        TileOrigin = vec2(0.0);
+        TileRepeat = vec2(0.0);
 
-    // 在顶点着色器中解码，避免片段插值后 floor/fract 精度问题
-    // +0.001 防止 14.99999 被 floor 到 14
-    SkyLight   = floor(aLightLevel + 0.001);
-    BlockLight = fract(aLightLevel + 0.001) * 16.0;
+        // 在顶点着色器中解码，避免片段插值后 floor/fract 精度问题
+        // +0.001 防止 14.99999 被 floor 到 14
+        SkyLight   = floor(aLightLevel + 0.001);
+        BlockLight = fract(aLightLevel + 0.001) * 16.0;
+    }
 
+    vec4 worldPos = model * vec4(position, 1.0);
+    gl_Position = projection * view * worldPos;
     FragDist = length(viewPos - worldPos.xyz);
 }
@@ -69,6 +69,12 @@ public:
         cameraPos = Position;
     }
 
+    // 远平面随渲染距离调整，保证雾效完全覆盖前地形不被裁掉
+    void set_far_plane(float far)
+    {
+        zFar = far;
+    }
+
 private:
     void update_view();
 
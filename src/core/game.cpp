@@ -2,7 +2,7 @@
 
 using namespace std;
 
-Game::Game(bool& gameState, int seed)
+Game::Game(bool& gameState, int seed, SaveMode saveMode, const WorldGenSettings& genSettings)
 {
     // 初始化世界种子
     this->seed = seed;
@@ -47,10 +47,12 @@ Game::Game(bool& gameState, int seed)
     blockShader.use();
 
     player.upload_data("./Textures/steve.png");
-    terrain.init_terrain(this->seed, player.position, "./Textures/DefaultPack.png");
+    terrain.set_gen_settings(genSettings);
+    terrain.init_terrain(this->seed, player.position, "./Textures/DefaultPack.png", saveMode);
     terrain.bind_block_texture(blockShader);
     player.bind_player_texture(blockShader);
     player.set_position(glm::vec3(0.5f, terrain.get_height(player.position)+1, 0.5f));
+    apply_render_distance(terrain.get_render_distance());
     blockShader.set_int("blockTexture", 1);
     blockShader.set_int("playerTexture", 2);
 
@@ -113,32 +115,9 @@ void Game::game_loop()
         glClearColor(skyColor.x, skyColor.y, skyColor.z, 1.0f); // 设置清空屏幕所用的颜色
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // 清除颜色缓冲和深度缓冲
 
-        glm::mat4 view = player.camera.get_view_matrix();                // 观察矩阵
-        glm::mat4 projection = player.camera.get_projection_matrix();    // 投影矩阵
-
-        glm::mat4 vpMatrix = projection * view;                            // VP矩阵用于视锥体剔除
-
-        // 先渲染天空（关闭深度测试，天空永远在最后面）
-        glDisable(GL_DEPTH_TEST);
-        skyBox.render(skyShader, view, projection, player.camera.cameraPos);
-        glEnable(GL_DEPTH_TEST);
-
-        // 渲染地形和玩家
-        blockShader.use();
+        glm::mat4 view, projection;
         player.update_position(terrain, deltaTime);
-        terrain.update_terrain(player.camera.cameraPos, &vpMatrix);       // 更新地形（带视锥剔除）
-        blockShader.set_mat4("view", view);
-        blockShader.set_mat4("projection", projection);
-        blockShader.set_vec3("viewPos", player.camera.cameraPos);
-        blockShader.set_vec2("viewRange", {CHUNK_SIZE*1.5f, CHUNK_SIZE*2});   // 视距
-        blockShader.set_vec3("skyColor", skyColor);
-        glm::vec3 ambientColor = skyBox.getAmbientColor();
-        blockShader.set_vec3("ambientColor", ambientColor);
-        terrain.draw_terrain(blockShader, vpMatrix, player.camera.cameraPos); // 绘制地形（带视锥剔除+透明排序）
-        if(!player.cameraMode)
-        {
-            player.draw_player(blockShader);
-        }
+        draw_world(view, projection);
 
         // 检测选中的方块
         blockSelected = false;
@@ -170,6 +149,20 @@ void Game::game_loop()
             std::stringstream ssTri;
             ssTri << "Tris:  " << displayTriangles;
             textRenderer.renderText(textShader, ssTri.str(), SCR_WIDTH - 130.0f, SCR_HEIGHT - 68.0f, 0.5f, glm::vec3(0.8f, 0.8f, 0.8f));
+
+            std::stringstream ssDist;
+            ssDist << "Dist:  " << terrain.get_render_distance();
+            textRenderer.renderText(textShader, ssDist.str(), SCR_WIDTH - 130.0f, SCR_HEIGHT - 84.0f, 0.5f, glm::vec3(0.8f, 0.8f, 0.8f));
+
+            // 各生命周期阶段的区块数：已请求 / 已生成 / 内部光照 / 邻居光照 / 构建中 / 已上传
+            size_t stages[STAGE_COUNT];
+            terrain.count_chunk_stages(stages);
+            std::stringstream ssStage;
+            ssStage << "R" << stages[STAGE_NONE]
+                    << " G" << stages[STAGE_TERRAIN] + stages[STAGE_CARVED] + stages[STAGE_DECORATED]
+                    << " L" << stages[STAGE_LIT] << " N" << stages[STAGE_NEIGHBOUR_LIT]
+                    << " M" << stages[STAGE_MESHED] << " U" << stages[STAGE_UPLOADED];
+            textRenderer.renderText(textShader, ssStage.str(), SCR_WIDTH - 200.0f, SCR_HEIGHT - 100.0f, 0.5f, glm::vec3(0.8f, 0.8f, 0.8f));
         }
 
         // 交换缓冲，重置光标到屏幕中心
@@ -180,6 +173,88 @@ void Game::game_loop()
     return ;
 }
 
+void Game::draw_world(glm::mat4& view, glm::mat4& projection)
+{
+    view = player.camera.get_view_matrix();                // 观察矩阵
+    projection = player.camera.get_projection_matrix();    // 投影矩阵
+
+    glm::mat4 vpMatrix = projection * view;                            // VP矩阵用于视锥体剔除
+
+    // 先渲染天空（关闭深度测试，天空永远在最后面）
+    glDisable(GL_DEPTH_TEST);
+    skyBox.render(skyShader, view, projection, player.camera.cameraPos);
+    glEnable(GL_DEPTH_TEST);
+
+    // 渲染地形和玩家
+    blockShader.use();
+    terrain.update_terrain(player.camera.cameraPos, &vpMatrix);       // 更新地形（带视锥剔除）
+    blockShader.set_mat4("view", view);
+    blockShader.set_mat4("projection", projection);
+    blockShader.set_vec3("viewPos", player.camera.cameraPos);
+    blockShader.set_vec2("viewRange", terrain.fog_range());           // 视距（随渲染距离变化）
+    blockShader.set_vec3("skyColor", skyColor);
+    glm::vec3 ambientColor = skyBox.getAmbientColor();
+    blockShader.set_vec3("ambientColor", ambientColor);
+    terrain.draw_terrain(blockShader, vpMatrix, player.camera.cameraPos); // 绘制地形（带视锥剔除+透明排序）
+    if(!player.cameraMode)
+    {
+        player.draw_player(blockShader);
+    }
+}
+
+void Game::apply_render_distance(int distance)
+{
+    terrain.set_render_distance(distance);
+    // 远平面放在雾效终点外一个区块，避免雾未完全覆盖时地形被裁掉
+    player.camera.set_far_plane(terrain.fog_range().y + CHUNK_SIZE);
+}
+
+void Game::benchmark_render_distance()
+{
+    const int radii[] = {2, 4, 8, 12, 16, 24, 32};
+    const int measuredFrames = 120;
+
+    cout << "radius  chunks  frame(ms)  fps     cpu(MB)  vram(MB)  load(s)" << endl;
+    for(int radius : radii)
+    {
+        apply_render_distance(radius);
+        glm::mat4 view, projection;
+
+        // 先等待窗口内区块全部生成并上传，加载时间单独统计
+        double loadStart = glfwGetTime();
+        do
+        {
+            glfwPollEvents();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            draw_world(view, projection);
+            glfwSwapBuffers(window);
+        } while(terrain.is_loading() && !glfwWindowShouldClose(window));
+        double loadTime = glfwGetTime() - loadStart;
+
+        // 摄像机静止，只测量稳态帧时间；glFinish 保证计入 GPU 耗时
+        double start = glfwGetTime();
+        for(int f = 0; f < measuredFrames; f++)
+        {
+            glfwPollEvents();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            draw_world(view, projection);
+            glFinish();
+            glfwSwapBuffers(window);
+        }
+        double frameMs = (glfwGetTime() - start) * 1000.0 / measuredFrames;
+        if(glfwWindowShouldClose(window)) break;
+
+        cout << std::left << std::fixed << std::setprecision(2)
+             << std::setw(8) << radius
+             << std::setw(8) << terrain.loaded_chunk_count()
+             << std::setw(11) << frameMs
+             << std::setw(8) << std::setprecision(1) << 1000.0 / frameMs
+             << std::setw(9) << terrain.chunk_memory_usage() / (1024.0 * 1024.0)
+             << std::setw(10) << terrain.vertex_memory_usage() / (1024.0 * 1024.0)
+             << std::setprecision(2) << loadTime << endl;
+    }
+}
+
 // 释放资源
 void Game::clear()
 {
@@ -268,6 +343,14 @@ void Game::key_callback(GLFWwindow* window, int key, int scancode, int action, i
                 glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
             }
         }
+        if(key == GLFW_KEY_EQUAL)
+        {
+            game->apply_render_distance(game->terrain.get_render_distance() + 1);
+        }
+        if(key == GLFW_KEY_MINUS)
+        {
+            game->apply_render_distance(game->terrain.get_render_distance() - 1);
+        }
         if(key == GLFW_KEY_ESCAPE)
         {
             glfwSetWindowShouldClose(window, true);
@@ -59,7 +59,8 @@ class Game
         GLFWwindow* window;             // 游戏窗口
         toolBar toolbar;                // 界面下方的工具栏
 
-        Game(bool& gameState, int seed = 666);
+        Game(bool& gameState, int seed = 666, SaveMode saveMode = SAVE_REGION,
+             const WorldGenSettings& genSettings = WorldGenSettings());
 
         // 设置窗口属性，绑定发生窗口事件时调用的函数
         void set_wondow_properties();
@@ -67,6 +68,15 @@ class Game
         // 游戏主循环
         void game_loop();
 
+        // 渲染天空、更新并绘制地形与玩家
+        void draw_world(glm::mat4& view, glm::mat4& projection);
+
+        // 按渲染距离调整雾效与远平面
+        void apply_render_distance(int distance);
+
+        // 渲染距离基准测试：依次测量各半径下的平均帧时间与内存占用，结果输出到控制台
+        void benchmark_render_distance();
+
         // 释放资源
         void clear();
 
@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
 
 struct Vertex
 {
@@ -13,6 +14,43 @@ struct Vertex
     float     LightLevel = 15.0f;  // 编码光照：整数部分=天空光(0~15)，小数部分=方块光/16
 };
 
+// 地形顶点：两个 32 位整数共 8 字节（Vertex 为 36 字节），解码见 blockShader.vs
+// lo: x(6) | y(8) | z(6) | face(3) | light(8)
+//     坐标为区块局部的方块角点 x, z ∈ [0, CHUNK_SIZE]，y ∈ [0, CHUNK_HEIGHT]
+//     face 为面方向（下标同 Chunk::faceNormal），light 为光照字节（高 4 位天空光，低 4 位方块光）
+// hi: tile(8) | u(6) | v(6)
+//     tile = 行 * 16 + 列（16×16 纹理图集），(u, v) 为格内重复坐标 ∈ [0, 32]
+// 玩家模型与 HUD 仍使用 Vertex
+struct TerrainVertex
+{
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+
+    TerrainVertex() {}
+
+    TerrainVertex(const glm::vec3& position, int face, int tile, int u, int v, uint8_t light)
+    {
+        lo = (uint32_t)position.x | (uint32_t)position.y << 6 | (uint32_t)position.z << 14
+           | (uint32_t)face << 20 | (uint32_t)light << 23;
+        hi = (uint32_t)tile | (uint32_t)u << 8 | (uint32_t)v << 14;
+    }
+
+    glm::vec3 position() const
+    {
+        return glm::vec3((float)(lo & 63u), (float)((lo >> 6) & 255u), (float)((lo >> 14) & 63u));
+    }
+    int face() const { return (int)((lo >> 20) & 7u); }
+    uint8_t light() const { return (uint8_t)(lo >> 23); }
+    int tile() const { return (int)(hi & 255u); }
+    int u() const { return (int)((hi >> 8) & 63u); }
+    int v() const { return (int)((hi >> 14) & 63u); }
+
+    void set_light(uint8_t light)
+    {
+        lo = (lo & 0x007FFFFFu) | (uint32_t)light << 23;
+    }
+};
+
 struct Triangle
 {
     Vertex Verteices[3];
@@ -0,0 +1,167 @@
+#include "vertex_arena.h"
+#include <algorithm>
+#include <cstring>
+
+void VertexArena::init(unsigned int vertexCount, unsigned int elementBuffer)
+{
+    destroy();
+    glGenVertexArrays(1, &VAO);
+    create_storage(vertexCount);
+    insert_free(0, capacity);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+    glBindVertexArray(0);
+}
+
+void VertexArena::destroy()
+{
+    if(VAO == 0) return;
+    for(auto& pending : fenced)
+        glDeleteSync(pending.first);
+    fenced.clear();
+    retiring.clear();
+    freeBlocks.clear();
+
+    glDeleteBuffers(1, &VBO);       // 删除缓冲同时解除映射
+    glDeleteVertexArrays(1, &VAO);
+    VAO = VBO = 0;
+    mapped = nullptr;
+    capacity = used = 0;
+}
+
+void VertexArena::create_storage(unsigned int vertexCount)
+{
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr bytes = (GLsizeiptr)vertexCount * sizeof(TerrainVertex);
+
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+    mapped = (TerrainVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags);
+    capacity = vertexCount;
+
+    // 顶点属性布局：location 4，整数属性，着色器中为 uvec2（见 blockShader.vs）
+    glBindVertexArray(VAO);
+    glEnableVertexAttribArray(4);
+    glVertexAttribIPointer(4, 2, GL_UNSIGNED_INT, sizeof(TerrainVertex), (void*)0);
+    glBindVertexArray(0);
+}
+
+void VertexArena::grow(unsigned int minCapacity)
+{
+    unsigned int oldVBO = VBO, oldCapacity = capacity;
+    unsigned int newCapacity = std::max(capacity, 1u);
+    while(newCapacity < minCapacity) newCapacity *= 2;
+
+    create_storage(newCapacity);
+
+    // GPU 端整体拷贝旧数据，已分配区间的偏移不变
+    glBindBuffer(GL_COPY_READ_BUFFER, oldVBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)oldCapacity * sizeof(TerrainVertex));
+
+    // 拷贝也会覆盖旧的空闲区间，必须等它完成后 CPU 才能写入新缓冲（扩容很少发生，允许这一次停顿）
+    GLsync copied = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glClientWaitSync(copied, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+    glDeleteSync(copied);
+
+    glDeleteBuffers(1, &oldVBO);    // 仍在使用旧缓冲的绘制由驱动保证完成后才真正释放
+    insert_free(oldCapacity, newCapacity - oldCapacity);
+}
+
+void VertexArena::insert_free(unsigned int offset, unsigned int count)
+{
+    // 与后一个空闲区间合并
+    auto next = freeBlocks.find(offset + count);
+    if(next != freeBlocks.end())
+    {
+        count += next->second;
+        freeBlocks.erase(next);
+    }
+    // 与前一个空闲区间合并
+    auto prev = freeBlocks.lower_bound(offset);
+    if(prev != freeBlocks.begin())
+    {
+        --prev;
+        if(prev->first + prev->second == offset)
+        {
+            prev->second += count;
+            return;
+        }
+    }
+    freeBlocks[offset] = count;
+}
+
+void VertexArena::reclaim()
+{
+    while(!fenced.empty())
+    {
+        GLenum status = glClientWaitSync(fenced.front().first, 0, 0);
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        for(const Range& range : fenced.front().second)
+        {
+            insert_free(range.offset, range.count);
+            used -= range.count;
+        }
+        glDeleteSync(fenced.front().first);
+        fenced.pop_front();
+    }
+}
+
+VertexArena::Range VertexArena::allocate(const std::vector<TerrainVertex>& data)
+{
+    Range range;
+    if(data.empty()) return range;
+    unsigned int count = (unsigned int)data.size();
+
+    auto find_fit = [&]() {
+        for(auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+        {
+            if(it->second >= count) return it;
+        }
+        return freeBlocks.end();
+    };
+
+    auto block = find_fit();
+    if(block == freeBlocks.end())
+    {
+        reclaim();
+        block = find_fit();
+    }
+    if(block == freeBlocks.end())
+    {
+        grow(capacity + count);
+        block = find_fit();
+    }
+
+    range.offset = block->first;
+    range.count = count;
+    unsigned int remaining = block->second - count;
+    freeBlocks.erase(block);
+    if(remaining > 0)
+        freeBlocks[range.offset + count] = remaining;
+    used += count;
+
+    std::memcpy(mapped + range.offset, data.data(), count * sizeof(TerrainVertex));
+    return range;
+}
+
+void VertexArena::release(Range& range)
+{
+    if(range.empty()) return;
+    retiring.push_back(range);
+    range = Range();
+}
+
+void VertexArena::end_frame()
+{
+    if(!retiring.empty())
+    {
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        fenced.emplace_back(fence, std::move(retiring));
+        retiring.clear();
+    }
+    reclaim();
+}
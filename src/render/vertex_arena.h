@@ -0,0 +1,84 @@
+#ifndef VERTEX_ARENA_H
+#define VERTEX_ARENA_H
+
+#include <glad/glad.h>
+#include "basic_struct.h"
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+// glMultiDrawElementsIndirect 的单条绘制命令（布局由 GL 规定）
+struct DrawElementsIndirectCommand
+{
+    GLuint count;           // 索引数
+    GLuint instanceCount;   // 实例数（地形恒为 1）
+    GLuint firstIndex;      // 索引缓冲起点
+    GLint  baseVertex;      // 顶点区间起点（VertexArena::Range::offset）
+    GLuint baseInstance;    // 逐实例属性的下标（地形用于选取区块原点）
+};
+
+// 地形顶点显存池
+//
+// 所有分段的 TerrainVertex 存放在同一个持久映射的大缓冲（glBufferStorage + MAP_PERSISTENT | MAP_COHERENT）中，
+// 由首次适配的空闲链表按顶点数分配区间，全部地形共用一个 VAO，绘制时以 baseVertex 指定区间起点：
+//   allocate() 分配一段未被 GPU 使用的区间并直接写入映射内存，不创建任何 GL 对象
+//   release()  释放的区间先进入待回收列表，end_frame() 为其插入 fence，
+//              GPU 执行完此前的绘制命令后才回到空闲链表，因此重建分段时不会与正在进行的绘制冲突
+// 空间不足时先回收已完成的 fence，仍不足则按倍数扩容（GPU 端拷贝旧数据，区间偏移保持不变）
+class VertexArena
+{
+    public:
+        // 一段顶点区间（单位：顶点）
+        struct Range
+        {
+            unsigned int offset = 0;
+            unsigned int count = 0;
+            bool empty() const { return count == 0; }
+        };
+
+    private:
+        unsigned int VAO = 0, VBO = 0;
+        TerrainVertex* mapped = nullptr;                                // 持久映射指针
+        unsigned int capacity = 0;                                      // 总容量（顶点）
+        unsigned int used = 0;                                          // 已分配（含待回收）顶点数
+
+        std::map<unsigned int, unsigned int> freeBlocks;                // 空闲区间：offset → count
+        std::vector<Range> retiring;                                    // 本帧释放、尚未插入 fence 的区间
+        std::deque<std::pair<GLsync, std::vector<Range>>> fenced;       // 等待 GPU 完成的区间
+
+        void create_storage(unsigned int vertexCount);
+        void grow(unsigned int minCapacity);
+        void insert_free(unsigned int offset, unsigned int count);      // 归还并与相邻空闲区间合并
+        void reclaim();                                                 // 回收已完成 fence 的区间（不阻塞）
+
+    public:
+        VertexArena(){};
+
+        ~VertexArena()
+        {
+            destroy();
+        }
+
+        // 创建缓冲与共享 VAO，elementBuffer 记录为 VAO 的默认索引缓冲（必须在 GL 线程调用）
+        void init(unsigned int vertexCount, unsigned int elementBuffer);
+        void destroy();
+
+        // 分配区间并写入顶点；data 为空时返回空区间
+        Range allocate(const std::vector<TerrainVertex>& data);
+
+        // 释放区间（延迟到 GPU 不再使用后复用），range 被置空
+        void release(Range& range);
+
+        // 每帧提交完地形绘制后调用：为本帧释放的区间插入 fence，并回收已完成的区间
+        void end_frame();
+
+        unsigned int vao() const { return VAO; }
+        unsigned int used_vertices() const { return used; }
+        unsigned int capacity_vertices() const { return capacity; }
+
+        VertexArena(const VertexArena&) = delete;
+        VertexArena& operator=(const VertexArena&) = delete;
+};
+
+#endif
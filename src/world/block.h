@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
 
 #define BLOCK_TYPE_NUM 14
 
@@ -30,20 +31,115 @@ struct Block
     BLOCK_TYPE type;
 };
 
-glm::vec2 get_tex_coord(unsigned int blockType, int face);
+#define BLOCK_FLAG_TRANSPARENT 0x1      // 可以透过此方块看到后面（邻居需要生成面片）
+#define BLOCK_FLAG_TRANSLUCENT 0x2      // 需要 alpha 混合渲染（进透明 Pass）
 
-// 返回方块在工具栏中显示的图标纹理左上角坐标
-glm::vec2 get_icon_tex_coord(BLOCK_TYPE blockType);
+// 纹理面：与 get_tex_coord 的 face 参数一致
+#define BLOCK_FACE_TOP 1
+#define BLOCK_FACE_BOTTOM 2
+#define BLOCK_FACE_SIDE 3
+
+// 单个方块的全部属性，新增方块只需在 BLOCK_DEFS 中追加一项
+// 纹理格子编号 = 行 * 16 + 列（16×16 图集，第 0 行在图集顶部）
+struct BlockDef
+{
+    BLOCK_TYPE type;                    // 须与所在下标一致（编译期检查）
+    uint8_t flags;                      // BLOCK_FLAG_*
+    uint8_t opacity;                    // 光穿过时的衰减，16 表示完全不透光
+    int8_t luminous;                    // 发光亮度，-1 表示不发光
+    uint8_t topTile;
+    uint8_t bottomTile;
+    uint8_t sideTile;
+    uint8_t iconTile;                   // 工具栏图标
+};
+
+constexpr BlockDef BLOCK_DEFS[BLOCK_TYPE_NUM] = {
+    // {类型, 标志, 光衰减, 发光亮度, 顶面格子, 底面格子, 侧面格子, 图标格子}
+    {AIR,     BLOCK_FLAG_TRANSPARENT,                             1, -1,   0,   0,   0,   0},
+    {GRASS,   0,                                                 16, -1,   0,   2,   3,   0},
+    {STONE,   0,                                                 16, -1,   1,   1,   1,   1},
+    {SAND,    0,                                                 16, -1,  18,  18,  18,  18},
+    {WATER,   BLOCK_FLAG_TRANSPARENT | BLOCK_FLAG_TRANSLUCENT,    2, -1, 205, 205, 205, 205},
+    {SOIL,    0,                                                 16, -1,   2,   2,   2,   2},
+    {WOOD,    0,                                                 16, -1,  21,  21,  20,  20},
+    {GLASS,   BLOCK_FLAG_TRANSPARENT | BLOCK_FLAG_TRANSLUCENT,    1, -1,  49,  49,  49,  49},
+    {COAL,    0,                                                 16, -1,  34,  34,  34,  34},
+    {IRON,    0,                                                 16, -1,  33,  33,  33,  33},
+    {GOLD,    0,                                                 16, -1,  32,  32,  32,  32},
+    {DIAMOND, 0,                                                 16, -1,  50,  50,  50,  50},
+    {TORCH,   BLOCK_FLAG_TRANSPARENT,                             1, 14,  80,  80,  80,  80},
+    {LEAF,    BLOCK_FLAG_TRANSPARENT,                             3, -1,  52,  52,  52,  52},
+};
+
+// 按属性拆开的查询表（struct-of-arrays）：热循环只触及需要的那一列，整表只有几十字节
+struct BlockTable
+{
+    uint8_t flags[BLOCK_TYPE_NUM];
+    uint8_t opacity[BLOCK_TYPE_NUM];
+    int8_t luminous[BLOCK_TYPE_NUM];
+    uint8_t tile[4][BLOCK_TYPE_NUM];    // [BLOCK_FACE_*][类型]，下标 0 为图标
+};
+
+constexpr BlockTable make_block_table()
+{
+    BlockTable table = {};
+    for(int t = 0; t < BLOCK_TYPE_NUM; t++)
+    {
+        const BlockDef& def = BLOCK_DEFS[t];
+        table.flags[t] = def.flags;
+        table.opacity[t] = def.opacity;
+        table.luminous[t] = def.luminous;
+        table.tile[0][t] = def.iconTile;
+        table.tile[BLOCK_FACE_TOP][t] = def.topTile;
+        table.tile[BLOCK_FACE_BOTTOM][t] = def.bottomTile;
+        table.tile[BLOCK_FACE_SIDE][t] = def.sideTile;
+    }
+    return table;
+}
+
+constexpr bool block_defs_in_order()
+{
+    for(int t = 0; t < BLOCK_TYPE_NUM; t++)
+        if(BLOCK_DEFS[t].type != t) return false;
+    return true;
+}
+static_assert(block_defs_in_order(), "BLOCK_DEFS must be indexed by BLOCK_TYPE");
+
+inline constexpr BlockTable BLOCK_TABLE = make_block_table();
 
 // 可以透过此方块看到后面（邻居需要生成面片）
-bool is_transparent(BLOCK_TYPE blockType);
+inline bool is_transparent(BLOCK_TYPE blockType)
+{
+    return BLOCK_TABLE.flags[blockType] & BLOCK_FLAG_TRANSPARENT;
+}
 
 // 需要 alpha 混合渲染（进透明 Pass）
-bool is_translucent(BLOCK_TYPE blockType);
+inline bool is_translucent(BLOCK_TYPE blockType)
+{
+    return BLOCK_TABLE.flags[blockType] & BLOCK_FLAG_TRANSLUCENT;
+}
 
-int get_opacity(BLOCK_TYPE type);
+inline int get_opacity(BLOCK_TYPE type)
+{
+    return BLOCK_TABLE.opacity[type];
+}
 
 // 获取方块发光亮度（非发光方块返回 -1）
-short get_block_luminous(BLOCK_TYPE blockType);
+inline short get_block_luminous(BLOCK_TYPE blockType)
+{
+    return BLOCK_TABLE.luminous[blockType];
+}
+
+// 方块某个面的纹理格子（face = BLOCK_FACE_TOP/BOTTOM/SIDE）
+inline int get_block_tile(BLOCK_TYPE blockType, int face)
+{
+    return BLOCK_TABLE.tile[face][blockType];
+}
+
+// 返回左上顶点在纹理图集中的坐标（face = 1/2/3 上面/下面/侧面）
+glm::vec2 get_tex_coord(unsigned int blockType, int face);
+
+// 返回方块在工具栏中显示的图标纹理左上角坐标
+glm::vec2 get_icon_tex_coord(BLOCK_TYPE blockType);
 
 #endif
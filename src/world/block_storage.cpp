@@ -0,0 +1,131 @@
+#include "block_storage.h"
+
+using namespace std;
+
+void BlockStorage::init(int size, BLOCK_TYPE fillType)
+{
+    volume = size;
+    bits = 0;
+    palette.assign(1, fillType);
+    std::fill(paletteIndex, paletteIndex + BLOCK_TYPE_NUM, 0xFF);
+    paletteIndex[fillType] = 0;
+    vector<uint8_t>().swap(data);
+}
+
+int BlockStorage::add_to_palette(BLOCK_TYPE blockType)
+{
+    int p = (int)palette.size();
+    if(bits == 0)
+        repack(4);
+    else if(bits == 4 && p >= 16)
+        repack(8);
+    palette.push_back(blockType);
+    paletteIndex[blockType] = (uint8_t)p;
+    return p;
+}
+
+void BlockStorage::repack(int newBits)
+{
+    if(newBits == bits) return;
+    vector<uint8_t> old;
+    old.swap(data);
+    int oldBits = bits;
+
+    bits = newBits;
+    if(newBits == 0)
+    {
+        vector<uint8_t>().swap(data);
+        return;
+    }
+    data.assign(newBits == 4 ? (volume + 1) / 2 : volume, 0);
+    if(oldBits == 0) return;   // 旧数据全为下标 0
+    for(int idx = 0; idx < volume; idx++)
+    {
+        int value = (oldBits == 4) ? (old[idx >> 1] >> ((idx & 1) << 2)) & 0xF : old[idx];
+        set_index(idx, value);
+    }
+}
+
+void BlockStorage::compact()
+{
+    // 统计实际使用的调色板项
+    vector<int> counts(palette.size(), 0);
+    for(int idx = 0; idx < volume; idx++)
+        counts[get_index(idx)]++;
+
+    vector<int> remap(palette.size(), 0);
+    vector<BLOCK_TYPE> newPalette;
+    for(size_t p = 0; p < palette.size(); p++)
+    {
+        if(counts[p] == 0) continue;
+        remap[p] = (int)newPalette.size();
+        newPalette.push_back(palette[p]);
+    }
+    if(newPalette.size() == palette.size()) return;
+    if(newPalette.empty()) newPalette.push_back(palette[0]);
+
+    for(int idx = 0; idx < volume; idx++)
+        set_index(idx, remap[get_index(idx)]);
+    palette.swap(newPalette);
+    std::fill(paletteIndex, paletteIndex + BLOCK_TYPE_NUM, 0xFF);
+    for(size_t p = 0; p < palette.size(); p++)
+        paletteIndex[palette[p]] = (uint8_t)p;
+
+    if(palette.size() == 1)
+        repack(0);
+    else if(bits == 8 && palette.size() <= 16)
+        repack(4);
+}
+
+bool BlockStorage::has_luminous() const
+{
+    for(BLOCK_TYPE blockType : palette)
+    {
+        if(get_block_luminous(blockType) > 0)
+            return true;
+    }
+    return false;
+}
+
+void BlockStorage::serialize(vector<uint8_t>& out) const
+{
+    out.push_back((uint8_t)bits);
+    out.push_back((uint8_t)(palette.size() - 1));  // 调色板至多 256 项，存 size-1
+    for(BLOCK_TYPE blockType : palette)
+        out.push_back((uint8_t)blockType);
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+bool BlockStorage::deserialize(const uint8_t*& p, const uint8_t* end, int size)
+{
+    if(end - p < 2) return false;
+    int newBits = p[0];
+    size_t paletteSize = (size_t)p[1] + 1;
+    size_t dataSize = newBits == 0 ? 0 : (newBits == 4 ? (size + 1) / 2 : size);
+    if((newBits != 0 && newBits != 4 && newBits != 8) || (size_t)(end - p) < 2 + paletteSize + dataSize)
+        return false;
+    if((newBits == 0 && paletteSize != 1) || (newBits == 4 && paletteSize > 16))
+        return false;
+    p += 2;
+
+    volume = size;
+    bits = newBits;
+    palette.clear();
+    std::fill(paletteIndex, paletteIndex + BLOCK_TYPE_NUM, 0xFF);
+    for(size_t i = 0; i < paletteSize; i++)
+    {
+        if(p[i] >= BLOCK_TYPE_NUM) return false;
+        paletteIndex[p[i]] = (uint8_t)palette.size();
+        palette.push_back((BLOCK_TYPE)p[i]);
+    }
+    p += paletteSize;
+    data.assign(p, p + dataSize);
+    p += dataSize;
+
+    // 体素中的调色板下标不能越界
+    for(int idx = 0; idx < volume; idx++)
+    {
+        if((size_t)get_index(idx) >= palette.size()) return false;
+    }
+    return true;
+}
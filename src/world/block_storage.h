@@ -0,0 +1,95 @@
+#ifndef BLOCK_STORAGE_H
+#define BLOCK_STORAGE_H
+
+#include "block.h"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// 调色板压缩的方块存储
+//
+// 一个区块内的方块种类通常很少（草、土、石、水、空气……），
+// 因此每个体素只存调色板下标，按种类数选择位宽：
+//   palette.size() == 1   → 0bit，不分配体素数组（如全空气区段）
+//   palette.size() <= 16  → 4bit，每字节 2 个体素
+//   palette.size() <= 256 → 8bit，每字节 1 个体素
+// 所有体素存放在一段连续内存中，下标由调用方（Chunk）按 [i][j][k] 展平。
+class BlockStorage
+{
+    private:
+        std::vector<BLOCK_TYPE> palette;        // 调色板下标 → 方块类型
+        std::vector<uint8_t> data;              // 位压缩的调色板下标
+        int bits = 0;                           // 当前位宽（0、4 或 8）
+        int volume = 0;                         // 体素总数
+        uint8_t paletteIndex[BLOCK_TYPE_NUM];   // 方块类型 → 调色板下标（0xFF 表示不在调色板中）
+
+        // 读取第 idx 个体素的调色板下标
+        inline int get_index(int idx) const
+        {
+            if(bits == 4)
+                return (data[idx >> 1] >> ((idx & 1) << 2)) & 0xF;
+            if(bits == 8)
+                return data[idx];
+            return 0;
+        }
+
+        inline void set_index(int idx, int value)
+        {
+            if(bits == 4)
+            {
+                int shift = (idx & 1) << 2;
+                uint8_t& byte = data[idx >> 1];
+                byte = (uint8_t)((byte & ~(0xF << shift)) | (value << shift));
+            }
+            else if(bits == 8)
+            {
+                data[idx] = (uint8_t)value;
+            }
+            // bits == 0 时只可能写入下标 0，无需存储
+        }
+
+        // 将新方块类型加入调色板，超出当前位宽容量时扩展
+        int add_to_palette(BLOCK_TYPE blockType);
+
+        // 按新位宽重新打包所有体素
+        void repack(int newBits);
+
+    public:
+        BlockStorage() { std::fill(paletteIndex, paletteIndex + BLOCK_TYPE_NUM, 0xFF); }
+
+        // 初始化为 size 个同类方块（调色板仅含 fillType，不分配体素数组）
+        void init(int size, BLOCK_TYPE fillType = AIR);
+
+        inline BLOCK_TYPE get(int idx) const
+        {
+            return palette[get_index(idx)];
+        }
+
+        inline void set(int idx, BLOCK_TYPE blockType)
+        {
+            int p = paletteIndex[blockType];
+            if(p == 0xFF) p = add_to_palette(blockType);
+            set_index(idx, p);
+        }
+
+        // 去掉已不再使用的调色板项，并在可能时收缩位宽
+        void compact();
+
+        // 全部体素为同一种方块
+        bool is_uniform() const { return bits == 0; }
+
+        // 调色板中是否有发光方块（compact 之前可能含已不再使用的项，只用于跳过不含光源的区段）
+        bool has_luminous() const;
+
+        // 序列化为 [位宽][调色板长度][调色板][体素数据]，与内存中的压缩格式一致
+        void serialize(std::vector<uint8_t>& out) const;
+
+        // 从 p 处读取 serialize 写出的数据（体素总数为 size），成功时 p 前移到数据末尾
+        bool deserialize(const uint8_t*& p, const uint8_t* end, int size);
+
+        int bits_per_block() const { return bits; }
+        size_t palette_size() const { return palette.size(); }
+        size_t memory_usage() const { return data.capacity() + palette.capacity() * sizeof(BLOCK_TYPE); }
+};
+
+#endif
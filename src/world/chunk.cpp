@@ -1,5 +1,8 @@
-#include <glad/glad.h>
 #include "chunk.h"
+#include "chunk_mesher.h"
+#include "chunk_scheduler.h"
+#include "climate_cache.h"
+#include "world_rng.h"
 #include <algorithm>
 
 using namespace std;
@@ -40,132 +43,92 @@ const glm::ivec3 Chunk::arrayOffset[6] = {
       { 0,  0, -1},  // k-1 (数组Y方向-，向下)
   };
 
-void Chunk::create_face(Vertex& vertex1, Vertex& vertex2, Vertex& vertex3, Vertex& vertex4)
+// 在粗格点上采样区块 (x, y) 的洞穴密度，结果按 [gi][gj][gk] 排列
+// 格点覆盖区块两侧边界（每维 CHUNK_SIZE/latticeXZ + 1 个），坐标与逐方块采样相同，相邻区块在公共边界上取值一致
+static void sample_cave_lattice(PerlinNoise& perlinNoise, int x, int y, int latticeXZ, int latticeY, vector<double>& lattice)
 {
+    double step = 1.0f/CHUNK_SIZE;
+    int countXZ = CHUNK_SIZE/latticeXZ + 1, countY = CHUNK_HEIGHT/latticeY + 1;
+    vector<double> latticeZ(countY);
+    for(int gk = 0; gk < countY; gk++)
+        latticeZ[gk] = (double)(gk*latticeY)*0.1f;
 
-    vertices.push_back(vertex1);
-    vertices.push_back(vertex2);
-    vertices.push_back(vertex3);
-    vertices.push_back(vertex4);
-    indices.push_back((unsigned int)vertices.size()-2);
-    indices.push_back((unsigned int)vertices.size()-3);
-    indices.push_back((unsigned int)vertices.size()-4);
-    indices.push_back((unsigned int)vertices.size()-3);
-    indices.push_back((unsigned int)vertices.size()-2);
-    indices.push_back((unsigned int)vertices.size()-1);
-    return ;
-}
-
-void Chunk::create_face_transparent(Vertex& vertex1, Vertex& vertex2, Vertex& vertex3, Vertex& vertex4)
-{
-    verticesT.push_back(vertex1);
-    verticesT.push_back(vertex2);
-    verticesT.push_back(vertex3);
-    verticesT.push_back(vertex4);
-    indicesT.push_back((unsigned int)verticesT.size()-2);
-    indicesT.push_back((unsigned int)verticesT.size()-3);
-    indicesT.push_back((unsigned int)verticesT.size()-4);
-    indicesT.push_back((unsigned int)verticesT.size()-3);
-    indicesT.push_back((unsigned int)verticesT.size()-2);
-    indicesT.push_back((unsigned int)verticesT.size()-1);
-    // 记录面片中心用于每帧透明排序
-    transparentFaceCenters.push_back(
-        (vertex1.Position + vertex2.Position + vertex3.Position + vertex4.Position) * 0.25f);
-}
-
-void Chunk::upload_data()
-{
-    // 先释放当前对象持有的资源
-    if (VAO != 0) glDeleteVertexArrays(1, &VAO);
-    if (VBO != 0) glDeleteBuffers(1, &VBO);
-    if (EBO != 0) glDeleteBuffers(1, &EBO);
-
-    vertices.shrink_to_fit();
-    indices.shrink_to_fit();
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-    glGenBuffers(1, &VBO);
-
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, (size_t)(vertices.size() * sizeof(Vertex)), &vertices[0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Texcoord));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, LightLevel));
+    lattice.resize((size_t)countXZ*countXZ*countY);
+    for(int gi = 0; gi < countXZ; gi++)
+    {
+        for(int gj = 0; gj < countXZ; gj++)
+        {
+            perlinNoise.get_3D_perlin_noise_batch(((double)x+step*gj*latticeXZ)*3, ((double)y+step*gi*latticeXZ)*3,
+                                                  latticeZ.data(), countY, &lattice[((size_t)gi*countXZ+gj)*countY]);
+        }
+    }
 }
 
-void Chunk::upload_data_transparent()
+// 由格点三线性插值出第 i 行第 j 列的洞穴密度 out[1..height-1]
+static void interpolate_cave_column(const vector<double>& lattice, int i, int j, int latticeXZ, int latticeY, int height, double* out)
 {
-    // 先释放当前对象持有的资源
-    if (transparentVAO != 0) glDeleteVertexArrays(1, &transparentVAO);
-    if (transparentVBO != 0) glDeleteBuffers(1, &transparentVBO);
-    if (transparentEBO != 0) glDeleteBuffers(1, &transparentEBO);
-
-    verticesT.shrink_to_fit();
-    indicesT.shrink_to_fit();
-    glGenVertexArrays(1, &transparentVAO);
-    glBindVertexArray(transparentVAO);
-    glGenBuffers(1, &transparentVBO);
-
-    glGenBuffers(1, &transparentEBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, transparentEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesT.size() * sizeof(unsigned int), &indicesT[0], GL_DYNAMIC_DRAW);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, transparentVBO);
-    glBufferData(GL_ARRAY_BUFFER, (size_t)(verticesT.size() * sizeof(Vertex)), &verticesT[0], GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Texcoord));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, LightLevel));
+    int countXZ = CHUNK_SIZE/latticeXZ + 1, countY = CHUNK_HEIGHT/latticeY + 1;
+    int gi = i/latticeXZ, gj = j/latticeXZ;
+    double ti = (double)(i%latticeXZ)/latticeXZ, tj = (double)(j%latticeXZ)/latticeXZ;
+    const double* c00 = &lattice[((size_t)gi*countXZ+gj)*countY];
+    const double* c01 = c00 + countY;
+    const double* c10 = c00 + (size_t)countXZ*countY;
+    const double* c11 = c10 + countY;
+
+    // 先在水平面内双线性插值出该列的格点值，再沿高度线性插值
+    int needY = min(countY, (height-1)/latticeY + 2);
+    double column[CHUNK_HEIGHT + 1];
+    for(int gk = 0; gk < needY; gk++)
+    {
+        double a = c00[gk] + tj*(c01[gk] - c00[gk]);
+        double b = c10[gk] + tj*(c11[gk] - c10[gk]);
+        column[gk] = a + ti*(b - a);
+    }
+    for(int k = 1; k < height; k++)
+    {
+        int gk = k/latticeY;
+        double t = (double)(k%latticeY)/latticeY;
+        out[k] = column[gk] + t*(column[gk+1] - column[gk]);
+    }
 }
 
-Chunk::Chunk(PerlinNoise& perlinNoise, int x, int y)
+void Chunk::generate_terrain(PerlinNoise& perlinNoise, int x, int y, const WorldGenSettings& settings)
 {
-    VAO = 0; VBO = 0; EBO = 0;
-    transparentVAO = 0; transparentVBO = 0; transparentEBO = 0;
     double step = 1.0f/CHUNK_SIZE;
-    chunkBlocks.resize(CHUNK_SIZE);
-    heightMap.resize(CHUNK_SIZE);
-    skyLights.resize(CHUNK_SIZE * CHUNK_SIZE * CHUNK_HEIGHT, 0);
-    blockLights.resize(CHUNK_SIZE * CHUNK_SIZE * CHUNK_HEIGHT, 0);
+    init_slices();
+    heightMap = make_shared<vector<vector<int> > >(CHUNK_SIZE);
 
     // 计算水线高度
     int waterLevel = CHUNK_HEIGHT/2;
 
+    // 生成用随机数按 (种子, 区块坐标, 用途) 确定，以方块位置取值，与生成顺序和线程无关
+    WorldRng outcropRng(perlinNoise.get_seed(), x, y, RNG_STONE_OUTCROP);
+
+    // 噪声按整行批量采样（见 PerlinNoise 的批量接口）
+    double rowX[CHUNK_SIZE], rowNoise[CHUNK_SIZE], rowHeight[CHUNK_SIZE];
+    for(int j = 0; j < CHUNK_SIZE; j++)
+        rowX[j] = (double)x+step*j;
+
     // 基于二维柏林噪声生成随机地形
     for(int i = 0; i < CHUNK_SIZE; i++)
     {
-        chunkBlocks[CHUNK_SIZE-1-i].resize(CHUNK_SIZE);
-        heightMap[CHUNK_SIZE-1-i].resize(CHUNK_SIZE);
+        (*heightMap)[CHUNK_SIZE-1-i].resize(CHUNK_SIZE);
+        // 使用更平滑的噪声值，范围在 -1 到 1 之间
+        perlinNoise.get_2D_perlin_noise_batch(rowX, (double)y+step*i, CHUNK_SIZE, rowNoise);
+        // 使用分形噪声+多噪声图混合接近原版效果
+        generate_height_row(perlinNoise, x*CHUNK_SIZE, y*CHUNK_SIZE+i, rowHeight, settings.climate);
         for(int j = 0; j < CHUNK_SIZE; j++)
         {
-            chunkBlocks[CHUNK_SIZE-1-i][j].resize(CHUNK_HEIGHT, AIR);
-
-            // 使用更平滑的噪声值，范围在 -1 到 1 之间
-            double noiseValue = perlinNoise.get_2D_perlin_noice((double)x+step*j, (double)y+step*i);
+            double noiseValue = rowNoise[j];
 
             // // 计算地形高度，使用更自然的映射，确保有足够的水下地形
             // int height = floor((double)CHUNK_HEIGHT/2 * (noiseValue + 1.0f) * 0.6f + CHUNK_HEIGHT/3.0f);
 
-            // 使用分形噪声+多噪声图混合接近原版效果
-            int height = floor(generate_height(perlinNoise, x*CHUNK_SIZE+j, y*CHUNK_SIZE+i));
+            int height = floor(rowHeight[j]);
 
 
             height = max(1, min(height, CHUNK_HEIGHT-2)); // 限制高度范围
+            (*heightMap)[CHUNK_SIZE-1-i][j] = height-1;   // 雕刻洞穴前为地表方块的高度
 
             // 如果在水下
             if(height < waterLevel)
@@ -173,15 +136,15 @@ Chunk::Chunk(PerlinNoise& perlinNoise, int x, int y)
                 // 海底地形：沙层和石头
                 for(int k = 0; k < height-2; k++)
                 {
-                    chunkBlocks[CHUNK_SIZE-1-i][j][k] = STONE;
+                    set_block_at(CHUNK_SIZE-1-i, j, k, STONE);
                 }
-                chunkBlocks[CHUNK_SIZE-1-i][j][height-2] = STONE; // 石头层
-                chunkBlocks[CHUNK_SIZE-1-i][j][height-1] = SAND;  // 表层沙子
+                set_block_at(CHUNK_SIZE-1-i, j, height-2, STONE); // 石头层
+                set_block_at(CHUNK_SIZE-1-i, j, height-1, SAND);  // 表层沙子
 
                 // 填充水
                 for(int k = height; k < waterLevel; k++)
                 {
-                    chunkBlocks[CHUNK_SIZE-1-i][j][k] = WATER;
+                    set_block_at(CHUNK_SIZE-1-i, j, k, WATER);
                 }
             }
             else
@@ -195,7 +158,7 @@ Chunk::Chunk(PerlinNoise& perlinNoise, int x, int y)
                     // 如果整个柱体都很浅，全部用石头填充
                     for(int k = 0; k < height - 1; k++)
                     {
-                        chunkBlocks[CHUNK_SIZE-1-i][j][k] = STONE;
+                        set_block_at(CHUNK_SIZE-1-i, j, k, STONE);
                     }
                 }
                 else
@@ -204,261 +167,413 @@ Chunk::Chunk(PerlinNoise& perlinNoise, int x, int y)
                     int stoneEnd = height - soilDepth;
                     for(int k = 0; k < stoneEnd; k++)
                     {
-                        chunkBlocks[CHUNK_SIZE-1-i][j][k] = STONE;
+                        set_block_at(CHUNK_SIZE-1-i, j, k, STONE);
                     }
                 }
 
                 // 土壤层
                 for(int k = height - soilDepth; k < height - 1; k++)
                 {
-                    chunkBlocks[CHUNK_SIZE-1-i][j][k] = SOIL;
+                    set_block_at(CHUNK_SIZE-1-i, j, k, SOIL);
                 }
 
                 // 地表层
-                chunkBlocks[CHUNK_SIZE-1-i][j][height-1] = GRASS;
+                set_block_at(CHUNK_SIZE-1-i, j, height-1, GRASS);
 
                 // 如果地形较高，可能有石头露出
-                if(height > waterLevel + 32 && rand() % 100 < 20)
+                if(height > waterLevel + 32 && WorldRng::below(outcropRng.at(i*CHUNK_SIZE + j), 100) < 20)
                 {
-                    chunkBlocks[CHUNK_SIZE-1-i][j][height-1] = STONE;
+                    set_block_at(CHUNK_SIZE-1-i, j, height-1, STONE);
                 }
             }
+        }
+    }
+    stage = STAGE_TERRAIN;
+}
+
+void Chunk::carve_caves(PerlinNoise& perlinNoise, int x, int y, const WorldGenSettings& settings)
+{
+    double step = 1.0f/CHUNK_SIZE;
+
+    // 洞穴的高度坐标各列相同
+    double caveZ[CHUNK_HEIGHT], caveNoise[CHUNK_HEIGHT];
+    for(int k = 0; k < CHUNK_HEIGHT; k++)
+        caveZ[k] = (double)k*0.1f;
+
+    // 洞穴密度：格点间隔大于 1 时先采样整个区块的粗格点，各列再插值
+    int latticeXZ = settings.caveLatticeXZ, latticeY = settings.caveLatticeY;
+    bool coarseCaves = latticeXZ > 1 || latticeY > 1;
+    vector<double> caveLattice;
+    if(coarseCaves)
+        sample_cave_lattice(perlinNoise, x, y, latticeXZ, latticeY, caveLattice);
+
+    for(int i = 0; i < CHUNK_SIZE; i++)
+    {
+        for(int j = 0; j < CHUNK_SIZE; j++)
+        {
+            // 地表以下挖空，高度图改为最高的未挖空方块（整列挖空时为 0）
+            int height = (*heightMap)[CHUNK_SIZE-1-i][j] + 1;
+            (*heightMap)[CHUNK_SIZE-1-i][j] = 0;
 
-            // cout << height << endl;
+            if(coarseCaves)
+                interpolate_cave_column(caveLattice, i, j, latticeXZ, latticeY, height, caveNoise);
+            else
+                perlinNoise.get_3D_perlin_noise_batch(((double)x+step*j)*3, ((double)y+step*i)*3, caveZ + 1, height - 1, caveNoise + 1);
             for(int k = 1; k < height; k++)
             {
-                double caveNoise = perlinNoise.get_3D_perlin_noice(((double)x+step*j)*3, ((double)y+step*i)*3, (double)k*0.1f);
-                if(caveNoise > 0.4f)
+                if(caveNoise[k] > 0.4f)
                 {
-                    chunkBlocks[CHUNK_SIZE-1-i][j][k] = AIR;
+                    set_block_at(CHUNK_SIZE-1-i, j, k, AIR);
                 }
                 else
                 {
-                    heightMap[CHUNK_SIZE-1-i][j] = k;
+                    (*heightMap)[CHUNK_SIZE-1-i][j] = k;
                 }
             }
             // heightMap[CHUNK_SIZE-1-i][j] = max(heightMap[CHUNK_SIZE-1-i][j], waterLevel);
         }
     }
+    stage = STAGE_CARVED;
+}
+
+void Chunk::plan_trees(PerlinNoise& perlinNoise, int x, int y, vector<TreeRoot>& roots) const
+{
+    int waterLevel = CHUNK_HEIGHT/2;
+    WorldRng treeRng(perlinNoise.get_seed(), x, y, RNG_TREE);
 
-    // 生成树木：噪声控制区域密度 + 坐标哈希控制个体间距
-    for (int i = 1; i < CHUNK_SIZE-1; i++)
+    // 树木：噪声控制区域密度 + 按位置取随机数控制个体间距；树冠可以伸出区块边界，由邻居的 decorate 放置
+    roots.clear();
+    for (int i = 0; i < CHUNK_SIZE; i++)
     {
-        for (int j = 1; j < CHUNK_SIZE-1; j++)
+        for (int j = 0; j < CHUNK_SIZE; j++)
         {
             int ai = CHUNK_SIZE - 1 - i; // 数组第一维索引
-            int surfaceK = heightMap[ai][j];
+            int surfaceK = (*heightMap)[ai][j];
             // 地表必须是草地且高于水面
-            if (surfaceK <= waterLevel || chunkBlocks[ai][j][surfaceK] != GRASS) continue;
+            if (surfaceK <= waterLevel || block_at(ai, j, surfaceK) != GRASS) continue;
 
             // 用独立频率的噪声采样树木密度（偏移 1000 避免与地形相关）
             int wx = x * CHUNK_SIZE + j, wz = y * CHUNK_SIZE + i;
             double treeNoise = perlinNoise.get_2D_perlin_noice((wx + 1000.0) * 0.05, (wz + 1000.0) * 0.05);
             if (treeNoise < 0.3) continue;
 
-            // 坐标哈希稀疏化，保证确定性且树间有间距
-            unsigned int h = (unsigned int)(wx * 73856093u ^ wz * 19349663u);
-            if (h % 37 != 0) continue;
+            // 按位置取随机数稀疏化，保证确定性且树间有间距
+            if (WorldRng::below(treeRng.at(i*CHUNK_SIZE + j), 37) != 0) continue;
+
+            // 树干高度 4~7（同一随机序列的后半段），顶部须留出树冠空间
+            int trunkHeight = 4 + (int)WorldRng::below(treeRng.at(CHUNK_SIZE*CHUNK_SIZE + i*CHUNK_SIZE + j), 4);
+            if (surfaceK + 1 + trunkHeight + 2 >= CHUNK_HEIGHT) continue;
 
-            create_tree({ai, j, surfaceK + 1});
+            roots.push_back({ai, j, surfaceK + 1, trunkHeight});
         }
     }
+}
 
-    // 初始化光照
-    init_local_light();
-
-    // 预计算方块纹理坐标
-    sideTexCoords = new glm::vec2[BLOCK_TYPE_NUM];
-    topTexCoords = new glm::vec2[BLOCK_TYPE_NUM];
-    bottomTexCoords = new glm::vec2[BLOCK_TYPE_NUM];
-    for(int blockType = 1; blockType < BLOCK_TYPE_NUM; ++blockType)
+void Chunk::decorate(const vector<TreeRoot>* area[9])
+{
+    // 邻居 (dx, dz) 的数组坐标换算到本区块：j 与 X 同向，i 与 Z 反向
+    // 放置规则（树干覆盖、树叶只填空气）与顺序无关，各区块只写自身，可以并行装饰
+    for(int dz = -1; dz <= 1; dz++)
     {
-        sideTexCoords[blockType] = get_tex_coord(blockType, 3);
-        topTexCoords[blockType] = get_tex_coord(blockType, 1);
-        bottomTexCoords[blockType] = get_tex_coord(blockType, 2);
+        for(int dx = -1; dx <= 1; dx++)
+        {
+            const vector<TreeRoot>* roots = area[(dz+1)*3 + (dx+1)];
+            if(!roots) continue;
+            for(const TreeRoot& root : *roots)
+            {
+                int ci = root.i - dz*CHUNK_SIZE, cj = root.j + dx*CHUNK_SIZE;
+                // 树冠半径至多 3 格，更远的树碰不到本区块
+                if(ci < -3 || ci >= CHUNK_SIZE+3 || cj < -3 || cj >= CHUNK_SIZE+3) continue;
+                create_tree({ci, cj, root.k}, root.trunkHeight);
+            }
+        }
     }
-
-    // 每个方块的索引即为其在该区块中的minCoord
-    meshUpdate = MESH_FULL_REBUILD;
-    lightUpdate = PROPAGATE;
+    stage = STAGE_DECORATED;
 }
 
-void Chunk::update_data(const Chunk* neighbours[4])
+void Chunk::finish_generation(const vector<uint32_t>* replay)
 {
-    vector<Vertex>().swap(vertices);
-    vector<unsigned int>().swap(indices);
-    vector<Vertex>().swap(verticesT);
-    vector<unsigned int>().swap(indicesT);
-    vector<glm::vec3>().swap(transparentFaceCenters);
-
-    // 边界面临时 buffer（遍历结束后追加到主 buffer）
-    vector<Vertex> bdrVerts, bdrVertsT;
-    vector<unsigned int> bdrIdx, bdrIdxT;
-    vector<glm::vec3> bdrFaceCenters;
-
-    glm::vec2 texRight = glm::vec2(1.0f/16.0f, 0.0f);
-    glm::vec2 texDown = glm::vec2(0.0f, -1.0f/16.0f);
-
-    // 单趟遍历：内部面直接写入主 buffer，边界面写入临时 buffer
-    for(int i = CHUNK_SIZE-1; i >= 0; i--)
+    // 重放玩家编辑：只写方块，光照在下方统一计算
+    if(replay)
     {
-        for(int j = 0; j < CHUNK_SIZE; j++)
+        for(uint32_t edit : *replay)
         {
-            for(int k = 0; k < CHUNK_HEIGHT; k++)
-            {
-                BLOCK_TYPE blockType = chunkBlocks[i][j][k];
-                if(blockType == AIR) continue;
+            int idx = (int)(edit >> 8);
+            BLOCK_TYPE blockType = (BLOCK_TYPE)(edit & 0xFF);
+            if(idx >= CHUNK_SIZE * CHUNK_SIZE * CHUNK_HEIGHT || blockType >= BLOCK_TYPE_NUM)
+                continue;
+            set_block_at(idx / (CHUNK_SIZE * CHUNK_HEIGHT), idx / CHUNK_HEIGHT % CHUNK_SIZE, idx % CHUNK_HEIGHT, blockType);
+        }
+        edits = *replay;
+    }
 
-                glm::vec3 blockPos(j, k, CHUNK_SIZE-1-i);
+    // 地形/洞穴/树木写入完毕，剔除被挖空后不再使用的调色板项
+    for(int s = 0; s < SECTION_NUM; s++)
+        slices[s]->blocks.compact();
 
-                // ===== 火把：十字交叉面片（2 对角 quad × 正反面 = 4 quad） =====
-                if(blockType == TORCH)
-                {
-                    glm::vec2 tex = sideTexCoords[TORCH];
-                    int idx = lightIdx(i, j, k);
-                    float light = (float)skyLights[idx] + (float)blockLights[idx] * 0.0625f;
-
-                    Vertex a0 = {blockPos + glm::vec3(0,1,1), faceNormal[5], tex,                    light};
-                    Vertex a1 = {blockPos + glm::vec3(1,1,0), faceNormal[5], tex + texRight,         light};
-                    Vertex a2 = {blockPos + glm::vec3(0,0,1), faceNormal[5], tex + texDown,          light};
-                    Vertex a3 = {blockPos + glm::vec3(1,0,0), faceNormal[5], tex + texRight+texDown, light};
-                    create_face(a0, a1, a2, a3);
-                    create_face(a0, a2, a1, a3);
-
-                    Vertex b0 = {blockPos + glm::vec3(1,1,1), faceNormal[3], tex,                    light};
-                    Vertex b1 = {blockPos + glm::vec3(0,1,0), faceNormal[3], tex + texRight,         light};
-                    Vertex b2 = {blockPos + glm::vec3(1,0,1), faceNormal[3], tex + texDown,          light};
-                    Vertex b3 = {blockPos + glm::vec3(0,0,0), faceNormal[3], tex + texRight+texDown, light};
-                    create_face(b0, b1, b2, b3);
-                    create_face(b0, b2, b1, b3);
+    // 初始化光照（重放的编辑可能含有火把等发光方块）
+    init_local_light();
+    init_torch_light();
 
-                    continue;
-                }
+    // 每个方块的索引即为其在该区块中的minCoord
+    for(int s = 0; s < SECTION_NUM; s++)
+        mark_section_dirty(s, MESH_FULL_REBUILD);
+    lightUpdate = PROPAGATE;
+    stage = STAGE_LIT;
+}
 
-                // ===== 常规方块：6 面检查 =====
-                glm::vec2 sideTex = sideTexCoords[blockType];
-                glm::vec2 topTex = topTexCoords[blockType];
-                glm::vec2 bottomTex = bottomTexCoords[blockType];
+void Chunk::mark_light_dirty(LightUpdateLevel level)
+{
+    lightUpdate = std::max(lightUpdate, level);
+    if(level >= FULL_RESET)
+        lower_stage(STAGE_DECORATED);
+    else if(level >= PROPAGATE)
+        lower_stage(STAGE_LIT);
+    else if(level > NONE)
+        lower_stage(STAGE_NEIGHBOUR_LIT);
+}
 
-                for(int face = 0; face < 6; ++face)
-                {
-                    BLOCK_TYPE neighborBlock = get_neighbor_block(i, j, k, face, neighbours);
-                    if(!is_transparent(neighborBlock)) continue;
-                    if(neighborBlock == blockType) continue;
+void Chunk::lower_stage(ChunkStage target)
+{
+    stage = std::min(stage, target);
+    if(scheduler)
+        scheduler->notify(schedulerIndex);
+}
 
-                    glm::vec2 tex = (face == 5) ? topTex : (face == 4) ? bottomTex : sideTex;
-                    float light = get_neighbor_combined_light(i, j, k, face, neighbours);
+void Chunk::init_slices()
+{
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        slices[s] = make_shared<ChunkSlice>();
+        slices[s]->blocks.init(SLICE_VOLUME, AIR);
+        std::fill(slices[s]->lights, slices[s]->lights + SLICE_VOLUME, 0);
+    }
+}
 
-                    Vertex v1 = {blockPos + faceVertexOffset[face][0], faceNormal[face], tex,                    light};
-                    Vertex v2 = {blockPos + faceVertexOffset[face][1], faceNormal[face], tex + texRight,         light};
-                    Vertex v3 = {blockPos + faceVertexOffset[face][2], faceNormal[face], tex + texDown,          light};
-                    Vertex v4 = {blockPos + faceVertexOffset[face][3], faceNormal[face], tex + texRight+texDown, light};
+ChunkSnapshot Chunk::snapshot() const
+{
+    ChunkSnapshot snap;
+    for(int s = 0; s < SECTION_NUM; s++)
+        snap.slices[s] = slices[s];
+    snap.heightMap = heightMap;
+    return snap;
+}
 
-                    if(is_border_face(i, j, face))
-                    {
-                        // 边界面 → 临时 buffer
-                        if(is_translucent(blockType))
-                        {
-                            bdrFaceCenters.push_back((v1.Position + v2.Position + v3.Position + v4.Position) * 0.25f);
-                            unsigned int base = (unsigned int)bdrVertsT.size();
-                            bdrVertsT.push_back(v1); bdrVertsT.push_back(v2);
-                            bdrVertsT.push_back(v3); bdrVertsT.push_back(v4);
-                            bdrIdxT.push_back(base+2); bdrIdxT.push_back(base+1); bdrIdxT.push_back(base);
-                            bdrIdxT.push_back(base+1); bdrIdxT.push_back(base+2); bdrIdxT.push_back(base+3);
-                        }
-                        else
-                        {
-                            unsigned int base = (unsigned int)bdrVerts.size();
-                            bdrVerts.push_back(v1); bdrVerts.push_back(v2);
-                            bdrVerts.push_back(v3); bdrVerts.push_back(v4);
-                            bdrIdx.push_back(base+2); bdrIdx.push_back(base+1); bdrIdx.push_back(base);
-                            bdrIdx.push_back(base+1); bdrIdx.push_back(base+2); bdrIdx.push_back(base+3);
-                        }
-                    }
-                    else
-                    {
-                        // 内部面 → 主 buffer
-                        if(is_translucent(blockType))
-                            create_face_transparent(v1, v2, v3, v4);
-                        else
-                            create_face(v1, v2, v3, v4);
-                    }
-                }
-            }
-        }
+void Chunk::mark_section_dirty(int s, MeshUpdateLevel level)
+{
+    if(s < 0 || s >= SECTION_NUM) return;
+    ChunkSection& section = sections[s];
+    if(level >= MESH_FULL_REBUILD)
+    {
+        // 几何范围可能变化，包围盒先恢复为整个分段，重建后再收紧
+        section.aabbMin = glm::vec3(0.0f, (float)(s * SECTION_HEIGHT), 0.0f);
+        section.aabbMax = glm::vec3((float)CHUNK_SIZE, (float)((s + 1) * SECTION_HEIGHT), (float)CHUNK_SIZE);
     }
+    section.meshUpdate = std::max(section.meshUpdate, level);
+    meshUpdate = std::max(meshUpdate, level);
+    lower_stage(STAGE_NEIGHBOUR_LIT);
+}
 
-    // 记录内部/边界分割点
-    borderVertexStart = vertices.size();
-    borderIndexStart = indices.size();
-    borderVertexTStart = verticesT.size();
-    borderIndexTStart = indicesT.size();
-    borderFaceCenterStart = transparentFaceCenters.size();
+int Chunk::top_solid_section() const
+{
+    for(int s = SECTION_NUM - 1; s >= 0; s--)
+        if(!is_section_empty(s)) return s;
+    return -1;
+}
 
-    // 追加边界面数据（索引需要 rebase）
-    if(!bdrVerts.empty())
+void Chunk::make_mesh_input(const Chunk* neighbours[4], ChunkMeshInput& input)
+{
+    for(int s = 0; s < SECTION_NUM; s++)
     {
-        unsigned int offset = (unsigned int)vertices.size();
-        vertices.insert(vertices.end(), bdrVerts.begin(), bdrVerts.end());
-        for(unsigned int idx : bdrIdx)
-            indices.push_back(idx + offset);
+        input.levels[s] = sections[s].meshUpdate;
+        sections[s].meshUpdate = MESH_NONE;
     }
-    if(!bdrVertsT.empty())
+    meshUpdate = MESH_NONE;
+    input.snapshot = snapshot();
+
+    // 邻居 n 朝向本区块的边界是它自己的第 (n ^ 1) 条边
+    for(int n = 0; n < 4; n++)
     {
-        unsigned int offset = (unsigned int)verticesT.size();
-        verticesT.insert(verticesT.end(), bdrVertsT.begin(), bdrVertsT.end());
-        for(unsigned int idx : bdrIdxT)
-            indicesT.push_back(idx + offset);
-        transparentFaceCenters.insert(transparentFaceCenters.end(),
-            bdrFaceCenters.begin(), bdrFaceCenters.end());
+        input.hasNeighbour[n] = (neighbours[n] != nullptr);
+        if(!neighbours[n]) continue;
+        input.borderBlocks[n].resize(CHUNK_SIZE * CHUNK_HEIGHT);
+        input.borderLights[n].resize(CHUNK_SIZE * CHUNK_HEIGHT);
+        neighbours[n]->export_border(n ^ 1, input.borderBlocks[n].data(), input.borderLights[n].data());
     }
-
-    upload_data();
-    upload_data_transparent();
-    meshUpdate = MESH_NONE;
 }
 
-BLOCK_TYPE Chunk::get_neighbor_block(
-    int i, int j, int k,
-    int face,
-    const Chunk* neighbours[4]
-) const
+void Chunk::export_border(int side, BLOCK_TYPE* blocks, uint8_t* borderLights) const
 {
-    // neighbours: [0]=left(-X), [1]=right(+X), [2]=forward(-Z), [3]=back(+Z)
-    // 法线 (mesh空间) → 数组偏移: di = -nz (数组i是反向Z), dj = nx, dk = ny
-    int ni = i - (int)faceNormal[face].z;
-    int nj = j + (int)faceNormal[face].x;
-    int nk = k + (int)faceNormal[face].y;
+    for(int p = 0; p < CHUNK_SIZE; p++)
+    {
+        int i = (side == 0 || side == 1) ? p : (side == 2 ? CHUNK_SIZE-1 : 0);
+        int j = (side == 2 || side == 3) ? p : (side == 1 ? CHUNK_SIZE-1 : 0);
+        for(int k = 0; k < CHUNK_HEIGHT; k++)
+        {
+            blocks[p * CHUNK_HEIGHT + k] = block_at(i, j, k);
+            borderLights[p * CHUNK_HEIGHT + k] = light_at(lightIdx(i, j, k));
+        }
+    }
+}
 
-    if(nk >= CHUNK_HEIGHT || nk < 0)
+unsigned int Chunk::apply_mesh(ChunkMeshResult& result)
+{
+    // 分段变为空时同样计入掩码，上传空数据即归还区间与透明索引缓冲
+    unsigned int dirty = 0;
+    for(SectionMesh& mesh : result.sections)
     {
-        return AIR;
+        sections[mesh.section].apply_mesh(mesh);
+        dirty |= 1u << mesh.section;
     }
-    if(ni >= 0 && ni < CHUNK_SIZE && nj >= 0 && nj < CHUNK_SIZE)
+    // 构建期间区块又被标记更新时保持退回后的阶段
+    if(stage == STAGE_MESHED)
+        stage = STAGE_UPLOADED;
+    return dirty;
+}
+
+void Chunk::release_meshes()
+{
+    for(int s = 0; s < SECTION_NUM; s++)
     {
-        return chunkBlocks[ni][nj][nk];
+        sections[s].release_mesh();
+        if(!is_section_empty(s))
+            mark_section_dirty(s, MESH_FULL_REBUILD);
     }
-    if(nj == CHUNK_SIZE && neighbours[1])
+    mark_light_dirty(PROPAGATE);
+}
+
+size_t Chunk::memory_usage() const
+{
+    size_t bytes = sizeof(Chunk) + CHUNK_SIZE * CHUNK_SIZE * sizeof(int);
+    for(const shared_ptr<ChunkSlice>& slice : slices)
     {
-        return neighbours[1]->get_block_type(0, CHUNK_SIZE-1-i, k);
+        if(slice)
+            bytes += sizeof(ChunkSlice) + slice->blocks.memory_usage();
     }
-    if(nj < 0 && neighbours[0])
+    for(const ChunkSection& section : sections)
     {
-        return neighbours[0]->get_block_type(CHUNK_SIZE-1, CHUNK_SIZE-1-i, k);
+        bytes += (section.vertices.capacity() + section.verticesT.capacity()) * sizeof(TerrainVertex);
+        bytes += section.indicesT.capacity() * sizeof(unsigned int);
+        bytes += section.transparentFaceCenters.capacity() * sizeof(glm::vec3);
     }
-    if(ni == CHUNK_SIZE && neighbours[2])
+    bytes += edits.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+bool Chunk::has_mesh() const
+{
+    for(const ChunkSection& section : sections)
     {
-        return neighbours[2]->get_block_type(j, CHUNK_SIZE-1, k);
+        if(!section.vertices.empty() || !section.verticesT.empty())
+            return true;
     }
-    if(ni < 0 && neighbours[3])
+    return false;
+}
+
+void ChunkSnapshot::serialize_blocks(vector<uint8_t>& out) const
+{
+    // 高度不超过 CHUNK_HEIGHT - 1，单字节即可
+    for(int i = 0; i < CHUNK_SIZE; i++)
+        for(int j = 0; j < CHUNK_SIZE; j++)
+            out.push_back((uint8_t)(*heightMap)[i][j]);
+    for(const shared_ptr<const ChunkSlice>& slice : slices)
     {
-        return neighbours[3]->get_block_type(j, 0, k);
+        out.push_back((uint8_t)(slice->nonAirCount & 0xFF));
+        out.push_back((uint8_t)(slice->nonAirCount >> 8));
+        slice->blocks.serialize(out);
+    }
+}
+
+void ChunkSnapshot::serialize_lights(vector<uint8_t>& out) const
+{
+    // 按 [i][j][k] 顺序编码：同一列的天空光连续，游程更长
+    uint8_t value = light_at(0, 0, 0);
+    int run = 0;
+    for(int i = 0; i < CHUNK_SIZE; i++)
+        for(int j = 0; j < CHUNK_SIZE; j++)
+            for(int k = 0; k < CHUNK_HEIGHT; k++)
+            {
+                uint8_t light = light_at(i, j, k);
+                if(light != value || run == 255)
+                {
+                    out.push_back(value);
+                    out.push_back((uint8_t)run);
+                    value = light;
+                    run = 0;
+                }
+                run++;
+            }
+    out.push_back(value);
+    out.push_back((uint8_t)run);
+}
+
+void Chunk::serialize_blocks(vector<uint8_t>& out) const
+{
+    snapshot().serialize_blocks(out);
+}
+
+bool Chunk::deserialize_blocks(const uint8_t* data, size_t size)
+{
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    if(size < CHUNK_SIZE * CHUNK_SIZE) return false;
+
+    heightMap = make_shared<vector<vector<int> > >(CHUNK_SIZE, vector<int>(CHUNK_SIZE));
+    for(int i = 0; i < CHUNK_SIZE; i++)
+        for(int j = 0; j < CHUNK_SIZE; j++)
+            (*heightMap)[i][j] = *p++;
+    init_slices();
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        if(end - p < 2) return false;
+        slices[s]->nonAirCount = p[0] | (p[1] << 8);
+        p += 2;
+        if(!slices[s]->blocks.deserialize(p, end, SLICE_VOLUME))
+            return false;
+        if(!is_section_empty(s))
+            mark_section_dirty(s, MESH_FULL_REBUILD);
     }
-    return AIR;
+    // 读回的区块方块已确定，内部光照（天空光与发光方块的方块光）由 Terrain 按 lightUpdate 重算（或由 deserialize_lights 恢复）
+    lightUpdate = FULL_RESET;
+    stage = STAGE_DECORATED;
+    return p == end;
+}
+
+void Chunk::serialize_lights(vector<uint8_t>& out) const
+{
+    snapshot().serialize_lights(out);
 }
 
-// 合并查询：一次邻居定位同时读取 skyLights + blockLights，编码为 sky + block/16.0
-float Chunk::get_neighbor_combined_light(
+bool Chunk::deserialize_lights(const uint8_t* data, size_t size)
+{
+    if(size % 2 != 0) return false;
+    // 游程按 [i][j][k] 顺序展开，idx 为 voxelIdx
+    size_t idx = 0, n = CHUNK_SIZE * CHUNK_SIZE * CHUNK_HEIGHT;
+    for(size_t p = 0; p < size; p += 2)
+    {
+        size_t run = data[p + 1];
+        if(run == 0 || idx + run > n) return false;
+        for(size_t r = 0; r < run; r++, idx++)
+        {
+            int i = (int)(idx / (CHUNK_SIZE * CHUNK_HEIGHT)), j = (int)(idx / CHUNK_HEIGHT % CHUNK_SIZE), k = (int)(idx % CHUNK_HEIGHT);
+            write_slice(k >> SECTION_SHIFT).lights[sectionIdx(i, j, k)] = data[p];
+        }
+    }
+    if(idx != n) return false;
+
+    // 存档中的边界光照来自保存时的邻居，只会被 update_chunk_light 调高、不会变暗：
+    // 天空光交给 remove_boundary_light 在四条边界上增量移除（Terrain 在区块内部光照阶段处理），
+    // 方块光的光源都是零散的发光方块，直接重新播种
+    for(int side = 0; side < 4; side++)
+        pendingBoundaryRemoval[side] = true;
+    init_torch_light();
+    lightUpdate = PROPAGATE;
+    stage = STAGE_DECORATED;
+    return true;
+}
+
+// 合并查询：一次邻居定位、一次字节读取同时取出天空光与方块光
+uint8_t Chunk::get_neighbor_light(
     int i, int j, int k,
     int face,
     const Chunk* neighbours[4]
@@ -468,92 +583,49 @@ float Chunk::get_neighbor_combined_light(
     int nj = j + (int)faceNormal[face].x;
     int nk = k + (int)faceNormal[face].y;
 
-    if(nk >= CHUNK_HEIGHT) return 15.0f;   // 世界顶部：天空满亮度，方块光 0
-    if(nk < 0) return 0.0f;
+    if(nk >= CHUNK_HEIGHT) return 0xF0;    // 世界顶部：天空满亮度，方块光 0
+    if(nk < 0) return 0;
 
-    float sky, block;
     if(ni >= 0 && ni < CHUNK_SIZE && nj >= 0 && nj < CHUNK_SIZE)
-    {
-        int idx = lightIdx(ni, nj, nk);
-        sky   = (float)skyLights[idx];
-        block = (float)blockLights[idx];
-    }
+        return light_at(lightIdx(ni, nj, nk));
     else if(nj == CHUNK_SIZE && neighbours[1])
-    {
-        glm::ivec3 nb{i, 0, nk};
-        sky   = (float)neighbours[1]->get_block_light(nb);
-        block = (float)neighbours[1]->get_torch_light(nb);
-    }
+        return neighbours[1]->light_at(lightIdx(i, 0, nk));
     else if(nj < 0 && neighbours[0])
-    {
-        glm::ivec3 nb{i, CHUNK_SIZE-1, nk};
-        sky   = (float)neighbours[0]->get_block_light(nb);
-        block = (float)neighbours[0]->get_torch_light(nb);
-    }
+        return neighbours[0]->light_at(lightIdx(i, CHUNK_SIZE-1, nk));
     else if(ni == CHUNK_SIZE && neighbours[2])
-    {
-        glm::ivec3 nb{0, j, nk};
-        sky   = (float)neighbours[2]->get_block_light(nb);
-        block = (float)neighbours[2]->get_torch_light(nb);
-    }
+        return neighbours[2]->light_at(lightIdx(0, j, nk));
     else if(ni < 0 && neighbours[3])
-    {
-        glm::ivec3 nb{CHUNK_SIZE-1, j, nk};
-        sky   = (float)neighbours[3]->get_block_light(nb);
-        block = (float)neighbours[3]->get_torch_light(nb);
-    }
-    else
-    {
-        return 15.0f;  // 邻居区块未加载，默认满亮度
-    }
-    return sky + block * 0.0625f;  // 编码：整数部分=天空光，小数部分=方块光/16
-}
-
-void Chunk::sort_transparent_faces(const glm::vec3& localCameraPos)
-{
-    int faceCount = (int)transparentFaceCenters.size();
-    if(faceCount <= 1) return;
-
-    // 创建面片索引数组 [0, 1, ..., N-1]
-    vector<int> faceOrder(faceCount);
-    for(int i = 0; i < faceCount; i++) faceOrder[i] = i;
-
-    // 按距离摄像机从远到近排序
-    sort(faceOrder.begin(), faceOrder.end(), [&](int a, int b) {
-        glm::vec3 da = transparentFaceCenters[a] - localCameraPos;
-        glm::vec3 db = transparentFaceCenters[b] - localCameraPos;
-        return glm::dot(da, da) > glm::dot(db, db);
-    });
-
-    // 按排序顺序重建 indicesT（每个面片固定模式: base+2, base+1, base+0, base+1, base+2, base+3）
-    for(int i = 0; i < faceCount; i++)
-    {
-        unsigned int base = faceOrder[i] * 4;
-        indicesT[i*6+0] = base + 2;
-        indicesT[i*6+1] = base + 1;
-        indicesT[i*6+2] = base + 0;
-        indicesT[i*6+3] = base + 1;
-        indicesT[i*6+4] = base + 2;
-        indicesT[i*6+5] = base + 3;
-    }
-
-    // 仅重传透明EBO（VBO不动）
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, transparentEBO);
-    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indicesT.size() * sizeof(unsigned int), indicesT.data());
+        return neighbours[3]->light_at(lightIdx(CHUNK_SIZE-1, j, nk));
+    return 0xF0;   // 邻居区块未加载，默认满亮度
 }
 
 bool Chunk::set_block(int x, int y, int z, BLOCK_TYPE blockType, Chunk* neighbours[4])
 {
     if(z < 0 || z >= CHUNK_HEIGHT) return false;
-    BLOCK_TYPE oldType = chunkBlocks[CHUNK_SIZE-1-y][x][z];
+    BLOCK_TYPE oldType = block_at(CHUNK_SIZE-1-y, x, z);
     if(oldType == blockType) return false;
-    chunkBlocks[CHUNK_SIZE-1-y][x][z] = blockType;
+    set_block_at(CHUNK_SIZE-1-y, x, z, blockType);
+    modified = true;
 
     int i = CHUNK_SIZE-1-y;
     int j = x;
 
-    // 标记自身：完整重建 mesh + 增量光照更新
-    meshUpdate = std::max(meshUpdate, MESH_FULL_REBUILD);
+    // 记录编辑（增量存档只保存这些记录）
+    uint32_t key = (uint32_t)voxelIdx(i, j, z) << 8;
+    auto pos = std::lower_bound(edits.begin(), edits.end(), key);
+    if(pos != edits.end() && (*pos >> 8) == (key >> 8))
+        *pos = key | blockType;
+    else
+        edits.insert(pos, key | blockType);
+
+    // 标记自身：仅完整重建所在分段 + 增量光照更新
+    // 位于分段上/下边界时，相邻分段的朝向面片也会变化，一并重建
+    int s = z >> SECTION_SHIFT;
+    mark_section_dirty(s, MESH_FULL_REBUILD);
+    if((z & (SECTION_HEIGHT - 1)) == 0)
+        mark_section_dirty(s - 1, MESH_FULL_REBUILD);
+    if((z & (SECTION_HEIGHT - 1)) == SECTION_HEIGHT - 1)
+        mark_section_dirty(s + 1, MESH_FULL_REBUILD);
     bool isDestroy = (blockType == AIR && oldType != AIR);
 
     // 方块光通道：发光方块（火把等）的放置/破坏
@@ -562,7 +634,7 @@ bool Chunk::set_block(int x, int y, int z, BLOCK_TYPE blockType, Chunk* neighbou
     if(get_block_luminous(blockType) > 0)
         update_light_on_create_luminous({i, j, z}, blockType, neighbours);
 
-    // 非发光方块的不透明度变化：更新受影响的 blockLights 传播路径
+    // 非发光方块的不透明度变化：更新受影响的方块光传播路径
     if(get_block_luminous(oldType) <= 0 && get_block_luminous(blockType) <= 0
        && get_opacity(blockType) != get_opacity(oldType))
     {
@@ -571,16 +643,17 @@ bool Chunk::set_block(int x, int y, int z, BLOCK_TYPE blockType, Chunk* neighbou
             refill_block_light({i, j, z}, neighbours);
     }
 
-    // 天空光通道：仅当方块不透明度变化时才触发 skyLights 更新
-    // 透光方块互换（如 AIR↔TORCH）不影响 skyLights，跳过代价高昂的边界传播
+    // 天空光通道：仅当方块不透明度变化时才触发天空光更新
+    // 透光方块互换（如 AIR↔TORCH）不影响天空光，跳过代价高昂的边界传播
     if(get_opacity(blockType) != get_opacity(oldType))
     {
         pendingLightUpdates.push_back({{i, j, z}, isDestroy});
-        lightUpdate = std::max(lightUpdate, PROPAGATE);
+        mark_light_dirty(PROPAGATE);
+        lower_stage(STAGE_DECORATED);   // 增量光照先在区块内部处理
     }
     else
     {
-        lightUpdate = std::max(lightUpdate, VERTEX_ONLY);
+        mark_light_dirty(VERTEX_ONLY);
     }
 
     // 边界方块变化时标记邻居区块的边界面片需要更新
@@ -588,13 +661,13 @@ bool Chunk::set_block(int x, int y, int z, BLOCK_TYPE blockType, Chunk* neighbou
     if(is_transparent(blockType) != is_transparent(oldType))
     {
         if(i == 0 && neighbours[3])
-            neighbours[3]->meshUpdate = std::max(neighbours[3]->meshUpdate, MESH_BORDER_REFRESH);
+            neighbours[3]->mark_section_dirty(s, MESH_BORDER_REFRESH);
         if(i == CHUNK_SIZE-1 && neighbours[2])
-            neighbours[2]->meshUpdate = std::max(neighbours[2]->meshUpdate, MESH_BORDER_REFRESH);
+            neighbours[2]->mark_section_dirty(s, MESH_BORDER_REFRESH);
         if(j == 0 && neighbours[0])
-            neighbours[0]->meshUpdate = std::max(neighbours[0]->meshUpdate, MESH_BORDER_REFRESH);
+            neighbours[0]->mark_section_dirty(s, MESH_BORDER_REFRESH);
         if(j == CHUNK_SIZE-1 && neighbours[1])
-            neighbours[1]->meshUpdate = std::max(neighbours[1]->meshUpdate, MESH_BORDER_REFRESH);
+            neighbours[1]->mark_section_dirty(s, MESH_BORDER_REFRESH);
     }
 
     // 邻居光照标记（基于距离，光最远传播15格）
@@ -641,6 +714,44 @@ double spline_map_continental(double c)
     return 88 + (c - 0.5) * 60;                   // 山地: 88-118
 }
 
+// 由三个噪声场组合出地表高度
+static double combine_height(double continental, double erosion, double peaks)
+{
+    // 使用样条曲线映射 continental 值
+    double continentHeight = spline_map_continental(continental);
+
+    // erosion 控制 peaks 的影响程度（高侵蚀=更平坦）
+    double erosionFactor = 1.0 - (erosion + 1.0) * 0.4;  // [0.2, 1.0]
+    erosionFactor = max(0.1, erosionFactor);
+
+    double peakHeight = peaks * 25 * erosionFactor;
+
+    return continentHeight + peakHeight;
+}
+
+void Chunk::generate_height_row(PerlinNoise& perlinNoise, double worldX, double worldZ, double* out, ClimateCache* climate)
+{
+    // 各噪声场的频率与偏移同 generate_height
+    double xs[CHUNK_SIZE], continental[CHUNK_SIZE], erosion[CHUNK_SIZE], peaks[CHUNK_SIZE];
+    if(climate)
+        climate->sample_row((int)worldX, (int)worldZ, CHUNK_SIZE, continental, erosion);
+    else
+    {
+        for(int j = 0; j < CHUNK_SIZE; j++)
+            xs[j] = (worldX + j) * 0.005;
+        perlinNoise.get_fbm_noise_batch(xs, worldZ * 0.005, CHUNK_SIZE, 4, 0.5, 2.0, continental);
+        for(int j = 0; j < CHUNK_SIZE; j++)
+            xs[j] = (worldX + j) * 0.008 + 1000.0f;
+        perlinNoise.get_fbm_noise_batch(xs, worldZ * 0.008 + 1000.0f, CHUNK_SIZE, 4, 0.5, 2.0, erosion);
+    }
+    for(int j = 0; j < CHUNK_SIZE; j++)
+        xs[j] = (worldX + j) * 0.02 + 2000.0f;
+    perlinNoise.get_fbm_noise_batch(xs, worldZ * 0.02 + 2000.0f, CHUNK_SIZE, 6, 0.5, 2.0, peaks);
+
+    for(int j = 0; j < CHUNK_SIZE; j++)
+        out[j] = combine_height(continental[j], erosion[j], peaks[j]);
+}
+
 double Chunk::generate_height(PerlinNoise& perlinNoise, double worldX, double worldZ)
 {
     // 使用世界坐标而非区块相对坐标
@@ -658,49 +769,24 @@ double Chunk::generate_height(PerlinNoise& perlinNoise, double worldX, double wo
     double peaks = perlinNoise.get_fbm_noise(
         worldX * 0.02 + 2000.0f, worldZ * 0.02 + 2000.0f, 6, 0.5, 2.0);
 
-    // 使用样条曲线映射 continental 值
-    double continentHeight = spline_map_continental(continental);
-
-    // erosion 控制 peaks 的影响程度（高侵蚀=更平坦）
-    double erosionFactor = 1.0 - (erosion + 1.0) * 0.4;  // [0.2, 1.0]
-    erosionFactor = max(0.1, erosionFactor);
-
-    double peakHeight = peaks * 25 * erosionFactor;
-
-    return continentHeight + peakHeight;
+    return combine_height(continental, erosion, peaks);
 }
 
 Chunk::Chunk(Chunk&& other) noexcept
-      : chunkBlocks(std::move(other.chunkBlocks)),
-        heightMap(std::move(other.heightMap)),
-        skyLights(std::move(other.skyLights)),
-        blockLights(std::move(other.blockLights)),
-        vertices(std::move(other.vertices)),
-        verticesT(std::move(other.verticesT)),
-        transparentFaceCenters(std::move(other.transparentFaceCenters)),
-        indices(std::move(other.indices)),
-        indicesT(std::move(other.indicesT)),
-        VAO(other.VAO),
-        VBO(other.VBO),
-        EBO(other.EBO),
-        transparentVAO(other.transparentVAO),
-        transparentVBO(other.transparentVBO),
-        transparentEBO(other.transparentEBO),
+      : heightMap(std::move(other.heightMap)),
         meshUpdate(other.meshUpdate),
         lightUpdate(other.lightUpdate),
+        modified(other.modified),
+        persisted(other.persisted),
+        edits(std::move(other.edits)),
         pendingLightUpdates(std::move(other.pendingLightUpdates)),
-        borderVertexStart(other.borderVertexStart),
-        borderIndexStart(other.borderIndexStart),
-        borderVertexTStart(other.borderVertexTStart),
-        borderIndexTStart(other.borderIndexTStart),
-        borderFaceCenterStart(other.borderFaceCenterStart)
+        stage(other.stage)
   {
-      other.VAO = 0;
-      other.VBO = 0;
-      other.EBO = 0;
-      other.transparentVAO = 0;
-      other.transparentVBO = 0;
-      other.transparentEBO = 0;
+      for(int s = 0; s < SECTION_NUM; s++)
+      {
+          sections[s] = std::move(other.sections[s]);
+          slices[s] = std::move(other.slices[s]);
+      }
       other.meshUpdate = MESH_NONE;
       other.lightUpdate = NONE;
       for(int s = 0; s < 4; s++)
@@ -714,47 +800,22 @@ Chunk& Chunk::operator=(Chunk&& other) noexcept
 {
     if (this != &other)  // 防止自赋值
     {
-        // 先释放当前对象持有的资源
-        if (VAO != 0) glDeleteVertexArrays(1, &VAO);
-        if (VBO != 0) glDeleteBuffers(1, &VBO);
-        if (EBO != 0) glDeleteBuffers(1, &EBO);
-        if (transparentVAO != 0) glDeleteVertexArrays(1, &transparentVAO);
-        if (transparentVBO != 0) glDeleteBuffers(1, &transparentVBO);
-        if (transparentEBO != 0) glDeleteBuffers(1, &transparentEBO);
-
-        // 窃取源对象资源
-        chunkBlocks = std::move(other.chunkBlocks);
+        for(int s = 0; s < SECTION_NUM; s++)
+        {
+            sections[s] = std::move(other.sections[s]);
+            slices[s] = std::move(other.slices[s]);
+        }
         heightMap = std::move(other.heightMap);
-        skyLights = std::move(other.skyLights);
-        blockLights = std::move(other.blockLights);
-        vertices = std::move(other.vertices);
-        verticesT = std::move(other.verticesT);
-        transparentFaceCenters = std::move(other.transparentFaceCenters);
-        indices = std::move(other.indices);
-        indicesT = std::move(other.indicesT);
-        VAO = other.VAO;
-        VBO = other.VBO;
-        EBO = other.EBO;
-        transparentVAO = other.transparentVAO;
-        transparentVBO = other.transparentVBO;
-        transparentEBO = other.transparentEBO;
         meshUpdate = other.meshUpdate;
         lightUpdate = other.lightUpdate;
+        modified = other.modified;
+        persisted = other.persisted;
+        edits = std::move(other.edits);
         pendingLightUpdates = std::move(other.pendingLightUpdates);
+        stage = other.stage;
         for(int s = 0; s < 4; s++) pendingBoundaryRemoval[s] = other.pendingBoundaryRemoval[s];
-        borderVertexStart = other.borderVertexStart;
-        borderIndexStart = other.borderIndexStart;
-        borderVertexTStart = other.borderVertexTStart;
-        borderIndexTStart = other.borderIndexTStart;
-        borderFaceCenterStart = other.borderFaceCenterStart;
 
         // 源对象置空
-        other.VAO = 0;
-        other.VBO = 0;
-        other.EBO = 0;
-        other.transparentVAO = 0;
-        other.transparentVBO = 0;
-        other.transparentEBO = 0;
         other.meshUpdate = MESH_NONE;
         other.lightUpdate = NONE;
         for(int s = 0; s < 4; s++) other.pendingBoundaryRemoval[s] = false;
@@ -777,7 +838,7 @@ short Chunk::get_block_light(const glm::ivec3& index) const
     {
         return 0;
     }
-    return skyLights[lightIdx(index.x, index.y, index.z)];
+    return sky_at(lightIdx(index.x, index.y, index.z));
 }
 
 short Chunk::get_torch_light(const glm::ivec3& index) const
@@ -786,26 +847,38 @@ short Chunk::get_torch_light(const glm::ivec3& index) const
     {
         return 0;
     }
-    return blockLights[lightIdx(index.x, index.y, index.z)];
+    return torch_at(lightIdx(index.x, index.y, index.z));
 }
 
 void Chunk::init_local_light()
 {
-    // 重置所有光照值为0
-    std::fill(skyLights.begin(), skyLights.end(), (short)0);
+    // 重置所有天空光为0（保留低 4 位的方块光）
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        ChunkSlice& slice = write_slice(s);
+        for(uint8_t& l : slice.lights) l &= 0x0F;
+    }
+
+    // skyStart 及以上全部位于全空气分段：直接置 15，且其六邻居同为 15，无需入队 BFS；
+    // 只有最底一层 (k == skyStart) 需要向下方的非空分段传播
+    int skyStart = (top_solid_section() + 1) * SECTION_HEIGHT;
 
     std::queue<glm::ivec3 > lightBFS;
     for(int i = 0; i < CHUNK_SIZE; ++i)
     {
         for(int j = 0; j < CHUNK_SIZE; ++j)
         {
-            for(int k = CHUNK_HEIGHT-1; k >= 0; k--)
+            for(int k = CHUNK_HEIGHT-1; k > skyStart; k--)
             {
-                if(chunkBlocks[i][j][k] != AIR)
+                set_sky_at(lightIdx(i, j, k), 15);
+            }
+            for(int k = std::min(skyStart, CHUNK_HEIGHT-1); k >= 0; k--)
+            {
+                if(block_at(i, j, k) != AIR)
                 {
                     break;
                 }
-                skyLights[lightIdx(i, j, k)] = 15;
+                set_sky_at(lightIdx(i, j, k), 15);
                 lightBFS.push(glm::ivec3(i, j, k));
             }
         }
@@ -814,6 +887,59 @@ void Chunk::init_local_light()
     return ;
 }
 
+void Chunk::init_torch_light()
+{
+    // 重置所有方块光（保留高 4 位的天空光），全部发光方块同时作为种子，只做一次 BFS；
+    // 逐个调用 update_light_on_create_luminous 时，相互重叠的光照范围会被反复传播
+    std::queue<glm::ivec3> lightBFS;
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        ChunkSlice& slice = write_slice(s);
+        for(uint8_t& l : slice.lights) l &= 0xF0;
+        if(!slice.blocks.has_luminous())
+            continue;
+        for(int i = 0; i < CHUNK_SIZE; i++)
+        {
+            for(int j = 0; j < CHUNK_SIZE; j++)
+            {
+                for(int k = s * SECTION_HEIGHT; k < (s + 1) * SECTION_HEIGHT; k++)
+                {
+                    short luminous = get_block_luminous(block_at(i, j, k));
+                    if(luminous > 0)
+                    {
+                        set_torch_at(lightIdx(i, j, k), luminous);
+                        lightBFS.push(glm::ivec3(i, j, k));
+                    }
+                }
+            }
+        }
+    }
+    update_torch_light(lightBFS);
+}
+
+void Chunk::update_torch_light(std::queue<glm::ivec3>& lightBFS)
+{
+    while(!lightBFS.empty())
+    {
+        glm::ivec3 local = lightBFS.front();
+        lightBFS.pop();
+        short localLight = torch_at(lightIdx(local.x, local.y, local.z));
+        for(int d = 0; d < 6; ++d)
+        {
+            glm::ivec3 temp = local + arrayOffset[d];
+            if(!is_valid_index(temp))
+                continue;
+            if(torch_at(lightIdx(temp.x, temp.y, temp.z)) >= localLight)
+                continue;
+            short newLight = localLight - get_opacity(block_at(temp.x, temp.y, temp.z));
+            if(newLight <= 0)
+                continue;
+            set_torch_at(lightIdx(temp.x, temp.y, temp.z), newLight);
+            lightBFS.push(temp);
+        }
+    }
+}
+
 void Chunk::update_block_light(std::queue<glm::ivec3 >& lightBFS)
 {
     while(!lightBFS.empty())
@@ -827,17 +953,17 @@ void Chunk::update_block_light(std::queue<glm::ivec3 >& lightBFS)
             {
                 continue;
             }
-            else if(skyLights[lightIdx(temp.x, temp.y, temp.z)] >= skyLights[lightIdx(local.x, local.y, local.z)])
+            else if(sky_at(lightIdx(temp.x, temp.y, temp.z)) >= sky_at(lightIdx(local.x, local.y, local.z)))
             {
                 continue;
             }
-            int dec = get_opacity(chunkBlocks[temp.x][temp.y][temp.z]);
-            if(skyLights[lightIdx(local.x, local.y, local.z)] - dec <= 0)
+            int dec = get_opacity(block_at(temp.x, temp.y, temp.z));
+            if(sky_at(lightIdx(local.x, local.y, local.z)) - dec <= 0)
             {
-                skyLights[lightIdx(temp.x, temp.y, temp.z)] = 0;
+                set_sky_at(lightIdx(temp.x, temp.y, temp.z), 0);
                 continue;
             }
-            skyLights[lightIdx(temp.x, temp.y, temp.z)] = skyLights[lightIdx(local.x, local.y, local.z)] - dec;
+            set_sky_at(lightIdx(temp.x, temp.y, temp.z), sky_at(lightIdx(local.x, local.y, local.z)) - dec);
             lightBFS.push(temp);
         }
     }
@@ -851,23 +977,26 @@ void Chunk::update_chunk_light(const Chunk* neighbours[4])
     // i=0 侧邻居=back([3]), i=max 侧邻居=forward([2])
     std::queue<glm::ivec3> lightBFS;
 
+    // 全空气分段（skyStart 以上）的天空光恒为 15，邻居传入的光不可能更亮，跳过
+    int skyStart = std::min((top_solid_section() + 1) * SECTION_HEIGHT, CHUNK_HEIGHT);
+
     // j 方向边界: left / right
     for(int i = 0; i < CHUNK_SIZE; ++i)
     {
-        for(int k = 0; k < CHUNK_HEIGHT; ++k)
+        for(int k = 0; k < skyStart; ++k)
         {
             // j=0 侧 ← left
-            int newLight = neighbours[0]->get_block_light({i, CHUNK_SIZE-1, k}) - get_opacity(chunkBlocks[i][0][k]);
-            if(newLight > skyLights[lightIdx(i, 0, k)])
+            int newLight = neighbours[0]->get_block_light({i, CHUNK_SIZE-1, k}) - get_opacity(block_at(i, 0, k));
+            if(newLight > sky_at(lightIdx(i, 0, k)))
             {
-                skyLights[lightIdx(i, 0, k)] = newLight;
+                set_sky_at(lightIdx(i, 0, k), newLight);
                 lightBFS.push({i, 0, k});
             }
             // j=max 侧 ← right
-            newLight = neighbours[1]->get_block_light({i, 0, k}) - get_opacity(chunkBlocks[i][CHUNK_SIZE-1][k]);
-            if(newLight > skyLights[lightIdx(i, CHUNK_SIZE-1, k)])
+            newLight = neighbours[1]->get_block_light({i, 0, k}) - get_opacity(block_at(i, CHUNK_SIZE-1, k));
+            if(newLight > sky_at(lightIdx(i, CHUNK_SIZE-1, k)))
             {
-                skyLights[lightIdx(i, CHUNK_SIZE-1, k)] = newLight;
+                set_sky_at(lightIdx(i, CHUNK_SIZE-1, k), newLight);
                 lightBFS.push({i, CHUNK_SIZE-1, k});
             }
         }
@@ -876,35 +1005,48 @@ void Chunk::update_chunk_light(const Chunk* neighbours[4])
     // i 方向边界: forward / back
     for(int j = 0; j < CHUNK_SIZE; ++j)
     {
-        for(int k = 0; k < CHUNK_HEIGHT; ++k)
+        for(int k = 0; k < skyStart; ++k)
         {
             // i=max 侧 ← forward
-            int newLight = neighbours[2]->get_block_light({0, j, k}) - get_opacity(chunkBlocks[CHUNK_SIZE-1][j][k]);
-            if(newLight > skyLights[lightIdx(CHUNK_SIZE-1, j, k)])
+            int newLight = neighbours[2]->get_block_light({0, j, k}) - get_opacity(block_at(CHUNK_SIZE-1, j, k));
+            if(newLight > sky_at(lightIdx(CHUNK_SIZE-1, j, k)))
             {
-                skyLights[lightIdx(CHUNK_SIZE-1, j, k)] = newLight;
+                set_sky_at(lightIdx(CHUNK_SIZE-1, j, k), newLight);
                 lightBFS.push({CHUNK_SIZE-1, j, k});
             }
             // i=0 侧 ← back
-            newLight = neighbours[3]->get_block_light({CHUNK_SIZE-1, j, k}) - get_opacity(chunkBlocks[0][j][k]);
-            if(newLight > skyLights[lightIdx(0, j, k)])
+            newLight = neighbours[3]->get_block_light({CHUNK_SIZE-1, j, k}) - get_opacity(block_at(0, j, k));
+            if(newLight > sky_at(lightIdx(0, j, k)))
             {
-                skyLights[lightIdx(0, j, k)] = newLight;
+                set_sky_at(lightIdx(0, j, k), newLight);
                 lightBFS.push({0, j, k});
             }
         }
     }
     update_block_light(lightBFS);
-}
 
-int Chunk::normal_to_face(const glm::vec3& normal)
-{
-    if(normal.z > 0.5f)  return 0;  // Back:    +Z
-    if(normal.z < -0.5f) return 1;  // Forward: -Z
-    if(normal.x < -0.5f) return 2;  // Left:    -X
-    if(normal.x > 0.5f)  return 3;  // Right:   +X
-    if(normal.y < -0.5f) return 4;  // Down:    -Y
-    return 5;                        // Up:      +Y
+    // 方块光：重新生成或读回的区块只在内部传播了自己的光源，邻居火把照过边界的部分在这里拉取。
+    // 火把光可以出现在任意高度（包括全空气分段），因此遍历整个边界
+    auto pull_torch = [&](const Chunk* nb, const glm::ivec3& from, const glm::ivec3& to)
+    {
+        int newLight = nb->torch_at(lightIdx(from.x, from.y, from.z)) - get_opacity(block_at(to.x, to.y, to.z));
+        if(newLight > torch_at(lightIdx(to.x, to.y, to.z)))
+        {
+            set_torch_at(lightIdx(to.x, to.y, to.z), newLight);
+            lightBFS.push(to);
+        }
+    };
+    for(int p = 0; p < CHUNK_SIZE; ++p)
+    {
+        for(int k = 0; k < CHUNK_HEIGHT; ++k)
+        {
+            pull_torch(neighbours[0], {p, CHUNK_SIZE-1, k}, {p, 0, k});
+            pull_torch(neighbours[1], {p, 0, k}, {p, CHUNK_SIZE-1, k});
+            pull_torch(neighbours[2], {0, p, k}, {CHUNK_SIZE-1, p, k});
+            pull_torch(neighbours[3], {CHUNK_SIZE-1, p, k}, {0, p, k});
+        }
+    }
+    update_torch_light(lightBFS);
 }
 
 bool Chunk::is_border_face(int i, int j, int face)
@@ -915,140 +1057,87 @@ bool Chunk::is_border_face(int i, int j, int face)
     return (ni < 0 || ni >= CHUNK_SIZE || nj < 0 || nj >= CHUNK_SIZE);
 }
 
-void Chunk::upload_border_data()
-{
-    // 复用已有 VAO/VBO/EBO，仅重传数据
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-}
-
-void Chunk::upload_border_data_transparent()
-{
-    // 复用已有 transparentVAO/VBO/EBO，仅重传数据
-    glBindVertexArray(transparentVAO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, transparentEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesT.size() * sizeof(unsigned int), indicesT.data(), GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, transparentVBO);
-    glBufferData(GL_ARRAY_BUFFER, verticesT.size() * sizeof(Vertex), verticesT.data(), GL_STATIC_DRAW);
-}
-
-void Chunk::refresh_border_mesh(const Chunk* neighbours[4])
-{
-    // 截断到内部/边界分割点，丢弃旧的边界面片
-    vertices.resize(borderVertexStart);
-    indices.resize(borderIndexStart);
-    verticesT.resize(borderVertexTStart);
-    indicesT.resize(borderIndexTStart);
-    transparentFaceCenters.resize(borderFaceCenterStart);
-
-    glm::vec2 texRight = glm::vec2(1.0f/16.0f, 0.0f);
-    glm::vec2 texDown = glm::vec2(0.0f, -1.0f/16.0f);
-
-    // 生成单个边界面的 lambda
-    auto gen_border_face = [&](int i, int j, int k, int face)
-    {
-        BLOCK_TYPE blockType = chunkBlocks[i][j][k];
-        if(blockType == AIR || blockType == TORCH) return;
-
-        BLOCK_TYPE neighborBlock = get_neighbor_block(i, j, k, face, neighbours);
-        if(!is_transparent(neighborBlock)) return;
-        if(neighborBlock == blockType) return;
-
-        glm::vec3 blockPos(j, k, CHUNK_SIZE-1-i);
-        glm::vec2 tex = (face == 5) ? topTexCoords[blockType]
-                       : (face == 4) ? bottomTexCoords[blockType]
-                       : sideTexCoords[blockType];
-        float light = get_neighbor_combined_light(i, j, k, face, neighbours);
-
-        Vertex v1 = {blockPos + faceVertexOffset[face][0], faceNormal[face], tex,                    light};
-        Vertex v2 = {blockPos + faceVertexOffset[face][1], faceNormal[face], tex + texRight,         light};
-        Vertex v3 = {blockPos + faceVertexOffset[face][2], faceNormal[face], tex + texDown,          light};
-        Vertex v4 = {blockPos + faceVertexOffset[face][3], faceNormal[face], tex + texRight+texDown, light};
-        if(is_translucent(blockType))
-            create_face_transparent(v1, v2, v3, v4);
-        else
-            create_face(v1, v2, v3, v4);
-    };
-
-    // 只遍历 4 条边界线，每条线检查确定的 1 个面方向
-    // i=0 → face 0 (Back, +Z)
-    for(int j = 0; j < CHUNK_SIZE; j++)
-        for(int k = 0; k < CHUNK_HEIGHT; k++)
-            gen_border_face(0, j, k, 0);
-
-    // i=CHUNK_SIZE-1 → face 1 (Forward, -Z)
-    for(int j = 0; j < CHUNK_SIZE; j++)
-        for(int k = 0; k < CHUNK_HEIGHT; k++)
-            gen_border_face(CHUNK_SIZE-1, j, k, 1);
-
-    // j=0 → face 2 (Left, -X)
-    for(int i = 0; i < CHUNK_SIZE; i++)
-        for(int k = 0; k < CHUNK_HEIGHT; k++)
-            gen_border_face(i, 0, k, 2);
-
-    // j=CHUNK_SIZE-1 → face 3 (Right, +X)
-    for(int i = 0; i < CHUNK_SIZE; i++)
-        for(int k = 0; k < CHUNK_HEIGHT; k++)
-            gen_border_face(i, CHUNK_SIZE-1, k, 3);
-
-    upload_border_data();
-    upload_border_data_transparent();
-    meshUpdate = MESH_NONE;
-}
-
-void Chunk::refresh_vertex_lights(const Chunk* neighbours[4])
+unsigned int Chunk::refresh_vertex_lights(const Chunk* neighbours[4])
 {
-    // 每4个顶点组成一个面片，共享同一方块和面方向
-    for(size_t v = 0; v + 3 < vertices.size(); v += 4)
-    {
-        int face = normal_to_face(vertices[v].Normal);
-        glm::vec3 blockPos = vertices[v].Position - faceVertexOffset[face][0];
-        int i = CHUNK_SIZE - 1 - (int)blockPos.z;
-        int j = (int)blockPos.x;
-        int k = (int)blockPos.y;
-        float light;
-        if(is_valid_index({i, j, k}) && get_block_luminous(chunkBlocks[i][j][k]) > 0)
+    // 还没有 mesh 的分段不需要刷新，之后的构建会带上最新光照
+    // 面片的 4 个顶点光照相同，只比较首个顶点；没有任何光照字节变化的分段不必重新上传
+    unsigned int dirty = 0;
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        ChunkSection& section = sections[s];
+        vector<TerrainVertex>& vertices = section.vertices;
+        vector<TerrainVertex>& verticesT = section.verticesT;
+        bool changed = false;
+
+        // 每4个顶点组成一个面片，共享同一方块和面方向
+        for(size_t v = 0; v + 3 < vertices.size(); v += 4)
         {
-            int idx = lightIdx(i, j, k);
-            light = (float)skyLights[idx] + (float)blockLights[idx] * 0.0625f;
+            int face = vertices[v].face();
+            glm::vec3 blockPos = vertices[v].position() - faceVertexOffset[face][0];
+            int i = CHUNK_SIZE - 1 - (int)blockPos.z;
+            int j = (int)blockPos.x;
+            int k = (int)blockPos.y;
+            uint8_t light;
+            if(is_valid_index({i, j, k}) && get_block_luminous(block_at(i, j, k)) > 0)
+            {
+                light = light_at(lightIdx(i, j, k));
+            }
+            else
+            {
+                light = get_neighbor_light(i, j, k, face, neighbours);
+            }
+
+            // 贪婪合并的面片覆盖 w×h 个方块面（纹理重复坐标即跨度），
+            // 其中光照不再一致时无法只改顶点，标记分段完整重建
+            int w = vertices[v+1].u() - vertices[v].u();
+            int h = vertices[v+2].v() - vertices[v].v();
+            if((w > 1 || h > 1) && section.meshUpdate < MESH_FULL_REBUILD)
+            {
+                glm::vec3 du = (vertices[v+1].position() - vertices[v].position()) / (float)w;
+                glm::vec3 dv = (vertices[v+2].position() - vertices[v].position()) / (float)h;
+                for(int b = 0; b < h && section.meshUpdate < MESH_FULL_REBUILD; b++)
+                {
+                    for(int a = 0; a < w; a++)
+                    {
+                        glm::vec3 p = blockPos + du * (float)a + dv * (float)b;
+                        if(get_neighbor_light(CHUNK_SIZE - 1 - (int)p.z, (int)p.x, (int)p.y, face, neighbours) != light)
+                        {
+                            mark_section_dirty(s, MESH_FULL_REBUILD);
+                            break;
+                        }
+                    }
+                }
+            }
+            if(vertices[v].light() == light)
+                continue;
+            vertices[v].set_light(light);
+            vertices[v+1].set_light(light);
+            vertices[v+2].set_light(light);
+            vertices[v+3].set_light(light);
+            changed = true;
         }
-        else
+        for(size_t v = 0; v + 3 < verticesT.size(); v += 4)
         {
-            light = get_neighbor_combined_light(i, j, k, face, neighbours);
+            int face = verticesT[v].face();
+            glm::vec3 blockPos = verticesT[v].position() - faceVertexOffset[face][0];
+            int i = CHUNK_SIZE - 1 - (int)blockPos.z;
+            int j = (int)blockPos.x;
+            int k = (int)blockPos.y;
+            uint8_t light = get_neighbor_light(i, j, k, face, neighbours);
+            if(verticesT[v].light() == light)
+                continue;
+            verticesT[v].set_light(light);
+            verticesT[v+1].set_light(light);
+            verticesT[v+2].set_light(light);
+            verticesT[v+3].set_light(light);
+            changed = true;
         }
-        vertices[v].LightLevel   = light;
-        vertices[v+1].LightLevel = light;
-        vertices[v+2].LightLevel = light;
-        vertices[v+3].LightLevel = light;
-    }
-    for(size_t v = 0; v + 3 < verticesT.size(); v += 4)
-    {
-        int face = normal_to_face(verticesT[v].Normal);
-        glm::vec3 blockPos = verticesT[v].Position - faceVertexOffset[face][0];
-        int i = CHUNK_SIZE - 1 - (int)blockPos.z;
-        int j = (int)blockPos.x;
-        int k = (int)blockPos.y;
-        float light = get_neighbor_combined_light(i, j, k, face, neighbours);
-        verticesT[v].LightLevel   = light;
-        verticesT[v+1].LightLevel = light;
-        verticesT[v+2].LightLevel = light;
-        verticesT[v+3].LightLevel = light;
-    }
 
-    // 仅重传 VBO 数据（几何不变，VAO/EBO 不动）
-    if(!vertices.empty())
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
-    }
-    if(!verticesT.empty())
-    {
-        glBindBuffer(GL_ARRAY_BUFFER, transparentVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, verticesT.size() * sizeof(Vertex), verticesT.data());
+        // 仅改写了顶点（几何不变），由调用方重新上传
+        if(changed)
+            dirty |= 1u << s;
     }
+    return dirty;
 }
 
 void Chunk::process_pending_lights()
@@ -1095,16 +1184,16 @@ void Chunk::update_light_on_destroy(const glm::ivec3& pos)
 
     // 检查是否有天空光直射：上方为世界顶部或天空光柱 (light=15 的 AIR)
     bool hasSkyAbove = (pos.z + 1 >= CHUNK_HEIGHT) ||
-                       (chunkBlocks[pos.x][pos.y][pos.z + 1] == AIR &&
-                        skyLights[lightIdx(pos.x, pos.y, pos.z + 1)] == 15);
+                       (block_at(pos.x, pos.y, pos.z + 1) == AIR &&
+                        sky_at(lightIdx(pos.x, pos.y, pos.z + 1)) == 15);
 
     if(hasSkyAbove)
     {
         // 天空光向下传播，直到遇到非 AIR 方块
         for(int k = pos.z; k >= 0; k--)
         {
-            if(chunkBlocks[pos.x][pos.y][k] != AIR) break;
-            skyLights[lightIdx(pos.x, pos.y, k)] = 15;
+            if(block_at(pos.x, pos.y, k) != AIR) break;
+            set_sky_at(lightIdx(pos.x, pos.y, k), 15);
             lightBFS.push({pos.x, pos.y, k});
         }
     }
@@ -1116,21 +1205,21 @@ void Chunk::update_light_on_destroy(const glm::ivec3& pos)
         {
             glm::ivec3 nb = pos + arrayOffset[d];
             if(!is_valid_index(nb)) continue;
-            maxLight = std::max(maxLight, skyLights[lightIdx(nb.x, nb.y, nb.z)]);
+            maxLight = std::max(maxLight, sky_at(lightIdx(nb.x, nb.y, nb.z)));
         }
-        short newLight = maxLight - (short)get_opacity(chunkBlocks[pos.x][pos.y][pos.z]);
+        short newLight = maxLight - (short)get_opacity(block_at(pos.x, pos.y, pos.z));
         if(newLight > 0)
         {
-            skyLights[lightIdx(pos.x, pos.y, pos.z)] = newLight;
+            set_sky_at(lightIdx(pos.x, pos.y, pos.z), newLight);
             lightBFS.push(pos);
         }
     }
 
     // // 火把光源播种：光照等级 14
-    // if(chunkBlocks[pos.x][pos.y][pos.z] == TORCH)
+    // if(block_at(pos.x, pos.y, pos.z) == TORCH)
     // {
-    //     skyLights[lightIdx(pos.x, pos.y, pos.z)] = std::max(
-    //         skyLights[lightIdx(pos.x, pos.y, pos.z)], (short)14);
+    //     set_sky_at(lightIdx(pos.x, pos.y, pos.z), std::max(
+    //         sky_at(lightIdx(pos.x, pos.y, pos.z)), (short)14));
     //     lightBFS.push(pos);
     // }
 
@@ -1140,8 +1229,8 @@ void Chunk::update_light_on_destroy(const glm::ivec3& pos)
 void Chunk::update_light_on_create(const glm::ivec3& pos)
 {
     // 放置方块后，需要移除该位置原有的光照并重新传播
-    short oldLight = skyLights[lightIdx(pos.x, pos.y, pos.z)];
-    skyLights[lightIdx(pos.x, pos.y, pos.z)] = 0;
+    short oldLight = sky_at(lightIdx(pos.x, pos.y, pos.z));
+    set_sky_at(lightIdx(pos.x, pos.y, pos.z), 0);
     if(oldLight <= 0) return;
 
     // 光照移除 BFS：记录 {位置, 旧光照值}
@@ -1155,9 +1244,9 @@ void Chunk::update_light_on_create(const glm::ivec3& pos)
     {
         for(int k = pos.z - 1; k >= 0; k--)
         {
-            if(chunkBlocks[pos.x][pos.y][k] != AIR) break;
-            if(skyLights[lightIdx(pos.x, pos.y, k)] != 15) break;
-            skyLights[lightIdx(pos.x, pos.y, k)] = 0;
+            if(block_at(pos.x, pos.y, k) != AIR) break;
+            if(sky_at(lightIdx(pos.x, pos.y, k)) != 15) break;
+            set_sky_at(lightIdx(pos.x, pos.y, k), 0);
             removalQueue.push({{pos.x, pos.y, k}, 15});
         }
     }
@@ -1173,13 +1262,13 @@ void Chunk::update_light_on_create(const glm::ivec3& pos)
             glm::ivec3 nb = cur + arrayOffset[d];
             if(!is_valid_index(nb)) continue;
 
-            short nbLight = skyLights[lightIdx(nb.x, nb.y, nb.z)];
+            short nbLight = sky_at(lightIdx(nb.x, nb.y, nb.z));
             if(nbLight <= 0) continue;
 
             if(nbLight < curLight)
             {
                 // 该邻居的光照源自当前方块，清零并继续移除
-                skyLights[lightIdx(nb.x, nb.y, nb.z)] = 0;
+                set_sky_at(lightIdx(nb.x, nb.y, nb.z), 0);
                 removalQueue.push({nb, nbLight});
             }
             else
@@ -1191,17 +1280,17 @@ void Chunk::update_light_on_create(const glm::ivec3& pos)
     }
 
     // 移除 BFS 结束后，如果 pos 现在是 AIR（如破坏火把），恢复天空光柱
-    // if(chunkBlocks[pos.x][pos.y][pos.z] == AIR)
+    // if(block_at(pos.x, pos.y, pos.z) == AIR)
     // {
     //     bool hasSkyAbove = (pos.z + 1 >= CHUNK_HEIGHT) ||
-    //                        (chunkBlocks[pos.x][pos.y][pos.z + 1] == AIR &&
-    //                         skyLights[lightIdx(pos.x, pos.y, pos.z + 1)] == 15);
+    //                        (block_at(pos.x, pos.y, pos.z + 1) == AIR &&
+    //                         sky_at(lightIdx(pos.x, pos.y, pos.z + 1)) == 15);
     //     if(hasSkyAbove)
     //     {
     //         for(int k = pos.z; k >= 0; k--)
     //         {
-    //             if(chunkBlocks[pos.x][pos.y][k] != AIR) break;
-    //             skyLights[lightIdx(pos.x, pos.y, k)] = 15;
+    //             if(block_at(pos.x, pos.y, k) != AIR) break;
+    //             set_sky_at(lightIdx(pos.x, pos.y, k), 15);
     //             repropQueue.push({pos.x, pos.y, k});
     //         }
     //     }
@@ -1226,10 +1315,10 @@ void Chunk::remove_boundary_light(int side)
     // 用 lambda 统一处理单个格子：记录旧值并加入移除队列
     auto zero_cell = [&](int i, int j, int k)
     {
-        short old = skyLights[lightIdx(i, j, k)];
+        short old = sky_at(lightIdx(i, j, k));
         if(old > 0)
         {
-            skyLights[lightIdx(i, j, k)] = 0;
+            set_sky_at(lightIdx(i, j, k), 0);
             removalQueue.push({{i, j, k}, old});
         }
     };
@@ -1271,12 +1360,12 @@ void Chunk::remove_boundary_light(int side)
             glm::ivec3 nb = cur + arrayOffset[d];
             if(!is_valid_index(nb)) continue;
 
-            short nbLight = skyLights[lightIdx(nb.x, nb.y, nb.z)];
+            short nbLight = sky_at(lightIdx(nb.x, nb.y, nb.z));
             if(nbLight <= 0) continue;
 
             if(nbLight < curLight)
             {
-                skyLights[lightIdx(nb.x, nb.y, nb.z)] = 0;
+                set_sky_at(lightIdx(nb.x, nb.y, nb.z), 0);
                 removalQueue.push({nb, nbLight});
             }
             else
@@ -1293,10 +1382,10 @@ void Chunk::remove_boundary_light(int side)
     {
         for(int k = CHUNK_HEIGHT - 1; k >= 0; k--)
         {
-            if(chunkBlocks[i][j][k] != AIR) break;
-            if(skyLights[lightIdx(i, j, k)] == 0)
+            if(block_at(i, j, k) != AIR) break;
+            if(sky_at(lightIdx(i, j, k)) == 0)
             {
-                skyLights[lightIdx(i, j, k)] = 15;
+                set_sky_at(lightIdx(i, j, k), 15);
                 repropQueue.push({i, j, k});
             }
         }
@@ -1332,15 +1421,15 @@ static int resolve_cross_chunk(const glm::ivec3& pos, glm::ivec3& nbPos)
 
 void Chunk::update_light_on_create_luminous(const glm::ivec3& pos, BLOCK_TYPE blockType, Chunk* neighbours[4])
 {
-    // 放置发光方块后，以该位置为光源向外传播 blockLights。
-    // 传播可跨越区块边界：本区块 BFS 遇到边界时直接写入邻居的 blockLights，
+    // 放置发光方块后，以该位置为光源向外传播方块光。
+    // 传播可跨越区块边界：本区块 BFS 遇到边界时直接写入邻居的方块光，
     // 再在邻居区块内继续传播。火把光最远 14 格，CHUNK_SIZE=32，不会越过邻居的另一侧边界。
 
     short luminousLevel = get_block_luminous(blockType);
-    if(blockLights[lightIdx(pos.x, pos.y, pos.z)] >= luminousLevel)
+    if(torch_at(lightIdx(pos.x, pos.y, pos.z)) >= luminousLevel)
         return;
 
-    blockLights[lightIdx(pos.x, pos.y, pos.z)] = luminousLevel;
+    set_torch_at(lightIdx(pos.x, pos.y, pos.z), luminousLevel);
 
     std::queue<glm::ivec3> lightBFS;
     lightBFS.push(pos);
@@ -1353,7 +1442,7 @@ void Chunk::update_light_on_create_luminous(const glm::ivec3& pos, BLOCK_TYPE bl
     {
         glm::ivec3 local = lightBFS.front();
         lightBFS.pop();
-        short localLight = blockLights[lightIdx(local.x, local.y, local.z)];
+        short localLight = torch_at(lightIdx(local.x, local.y, local.z));
 
         for(int d = 0; d < 6; ++d)
         {
@@ -1361,28 +1450,28 @@ void Chunk::update_light_on_create_luminous(const glm::ivec3& pos, BLOCK_TYPE bl
 
             if(is_valid_index(temp))
             {
-                if(blockLights[lightIdx(temp.x, temp.y, temp.z)] >= localLight)
+                if(torch_at(lightIdx(temp.x, temp.y, temp.z)) >= localLight)
                     continue;
-                int dec = get_opacity(chunkBlocks[temp.x][temp.y][temp.z]);
+                int dec = get_opacity(block_at(temp.x, temp.y, temp.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                blockLights[lightIdx(temp.x, temp.y, temp.z)] = newLight;
+                set_torch_at(lightIdx(temp.x, temp.y, temp.z), newLight);
                 lightBFS.push(temp);
             }
             else
             {
-                // 跨区块：直接写入邻居的 blockLights 并收集种子
+                // 跨区块：直接写入邻居的方块光并收集种子
                 glm::ivec3 nbPos;
                 int nbIdx = resolve_cross_chunk(temp, nbPos);
                 if(nbIdx < 0 || !neighbours[nbIdx]) continue;
 
                 Chunk* nb = neighbours[nbIdx];
-                int dec = get_opacity(nb->chunkBlocks[nbPos.x][nbPos.y][nbPos.z]);
+                int dec = get_opacity(nb->block_at(nbPos.x, nbPos.y, nbPos.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                if(newLight <= nb->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)]) continue;
+                if(newLight <= nb->torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z))) continue;
 
-                nb->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)] = newLight;
+                nb->set_torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z), newLight);
                 nbSeeds[nbIdx].push(nbPos);
             }
         }
@@ -1398,24 +1487,24 @@ void Chunk::update_light_on_create_luminous(const glm::ivec3& pos, BLOCK_TYPE bl
         {
             glm::ivec3 local = nbSeeds[n].front();
             nbSeeds[n].pop();
-            short localLight = nb->blockLights[lightIdx(local.x, local.y, local.z)];
+            short localLight = nb->torch_at(lightIdx(local.x, local.y, local.z));
 
             for(int d = 0; d < 6; ++d)
             {
                 glm::ivec3 temp = local + arrayOffset[d];
                 if(!is_valid_index(temp)) continue; // 不会越过邻居的另一侧边界
-                if(nb->blockLights[lightIdx(temp.x, temp.y, temp.z)] >= localLight)
+                if(nb->torch_at(lightIdx(temp.x, temp.y, temp.z)) >= localLight)
                     continue;
-                int dec = get_opacity(nb->chunkBlocks[temp.x][temp.y][temp.z]);
+                int dec = get_opacity(nb->block_at(temp.x, temp.y, temp.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                nb->blockLights[lightIdx(temp.x, temp.y, temp.z)] = newLight;
+                nb->set_torch_at(lightIdx(temp.x, temp.y, temp.z), newLight);
                 nbSeeds[n].push(temp);
             }
         }
 
         // 标记邻居需要刷新顶点光照
-        nb->lightUpdate = std::max(nb->lightUpdate, VERTEX_ONLY);
+        nb->mark_light_dirty(VERTEX_ONLY);
     }
 }
 
@@ -1425,8 +1514,8 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
     // 需要移除从该光源传播出去的 blockLight（包括跨区块部分），再让其他独立光源重新填充。
     // 分四个阶段：本区块移除 → 邻居移除 → 本区块重传播 → 邻居重传播。
 
-    short oldLight = blockLights[lightIdx(pos.x, pos.y, pos.z)];
-    blockLights[lightIdx(pos.x, pos.y, pos.z)] = 0;
+    short oldLight = torch_at(lightIdx(pos.x, pos.y, pos.z));
+    set_torch_at(lightIdx(pos.x, pos.y, pos.z), 0);
     if(oldLight <= 0) return;
 
     std::queue<std::pair<glm::ivec3, short>> removalQueue;
@@ -1450,12 +1539,12 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
 
             if(is_valid_index(temp))
             {
-                short tLight = blockLights[lightIdx(temp.x, temp.y, temp.z)];
+                short tLight = torch_at(lightIdx(temp.x, temp.y, temp.z));
                 if(tLight <= 0) continue;
                 if(tLight < curLight)
                 {
                     // 依赖于当前光源，清零并继续移除
-                    blockLights[lightIdx(temp.x, temp.y, temp.z)] = 0;
+                    set_torch_at(lightIdx(temp.x, temp.y, temp.z), 0);
                     removalQueue.push({temp, tLight});
                 }
                 else
@@ -1472,11 +1561,11 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
                 if(nbIdx < 0 || !neighbours[nbIdx]) continue;
 
                 Chunk* nb = neighbours[nbIdx];
-                short nLight = nb->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)];
+                short nLight = nb->torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z));
                 if(nLight <= 0) continue;
                 if(nLight < curLight)
                 {
-                    nb->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)] = 0;
+                    nb->set_torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z), 0);
                     nbRemoval[nbIdx].push({nbPos, nLight});
                 }
                 else
@@ -1504,11 +1593,11 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
                 glm::ivec3 temp = cur + arrayOffset[d];
                 if(!is_valid_index(temp)) continue; // 不越过邻居的另一侧边界
 
-                short tLight = nb->blockLights[lightIdx(temp.x, temp.y, temp.z)];
+                short tLight = nb->torch_at(lightIdx(temp.x, temp.y, temp.z));
                 if(tLight <= 0) continue;
                 if(tLight < curLight)
                 {
-                    nb->blockLights[lightIdx(temp.x, temp.y, temp.z)] = 0;
+                    nb->set_torch_at(lightIdx(temp.x, temp.y, temp.z), 0);
                     nbRemoval[n].push({temp, tLight});
                 }
                 else
@@ -1524,7 +1613,7 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
     {
         glm::ivec3 local = repropQueue.front();
         repropQueue.pop();
-        short localLight = blockLights[lightIdx(local.x, local.y, local.z)];
+        short localLight = torch_at(lightIdx(local.x, local.y, local.z));
 
         for(int d = 0; d < 6; ++d)
         {
@@ -1532,12 +1621,12 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
 
             if(is_valid_index(temp))
             {
-                if(blockLights[lightIdx(temp.x, temp.y, temp.z)] >= localLight)
+                if(torch_at(lightIdx(temp.x, temp.y, temp.z)) >= localLight)
                     continue;
-                int dec = get_opacity(chunkBlocks[temp.x][temp.y][temp.z]);
+                int dec = get_opacity(block_at(temp.x, temp.y, temp.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                blockLights[lightIdx(temp.x, temp.y, temp.z)] = newLight;
+                set_torch_at(lightIdx(temp.x, temp.y, temp.z), newLight);
                 repropQueue.push(temp);
             }
             else
@@ -1548,12 +1637,12 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
                 if(nbIdx < 0 || !neighbours[nbIdx]) continue;
 
                 Chunk* nb = neighbours[nbIdx];
-                int dec = get_opacity(nb->chunkBlocks[nbPos.x][nbPos.y][nbPos.z]);
+                int dec = get_opacity(nb->block_at(nbPos.x, nbPos.y, nbPos.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                if(newLight <= nb->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)])
+                if(newLight <= nb->torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z)))
                     continue;
-                nb->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)] = newLight;
+                nb->set_torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z), newLight);
                 nbReprop[nbIdx].push(nbPos);
             }
         }
@@ -1570,30 +1659,30 @@ void Chunk::update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neigh
         {
             glm::ivec3 local = nbReprop[n].front();
             nbReprop[n].pop();
-            short localLight = nb->blockLights[lightIdx(local.x, local.y, local.z)];
+            short localLight = nb->torch_at(lightIdx(local.x, local.y, local.z));
 
             for(int d = 0; d < 6; ++d)
             {
                 glm::ivec3 temp = local + arrayOffset[d];
                 if(!is_valid_index(temp)) continue;
-                if(nb->blockLights[lightIdx(temp.x, temp.y, temp.z)] >= localLight)
+                if(nb->torch_at(lightIdx(temp.x, temp.y, temp.z)) >= localLight)
                     continue;
-                int dec = get_opacity(nb->chunkBlocks[temp.x][temp.y][temp.z]);
+                int dec = get_opacity(nb->block_at(temp.x, temp.y, temp.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                nb->blockLights[lightIdx(temp.x, temp.y, temp.z)] = newLight;
+                nb->set_torch_at(lightIdx(temp.x, temp.y, temp.z), newLight);
                 nbReprop[n].push(temp);
             }
         }
 
-        nb->lightUpdate = std::max(nb->lightUpdate, VERTEX_ONLY);
+        nb->mark_light_dirty(VERTEX_ONLY);
     }
 }
 
 void Chunk::refill_block_light(const glm::ivec3& pos, Chunk* neighbours[4])
 {
     // 破坏不透明方块后，从周围有 blockLight 的邻居重新填充并向外传播
-    int opacity = get_opacity(chunkBlocks[pos.x][pos.y][pos.z]);
+    int opacity = get_opacity(block_at(pos.x, pos.y, pos.z));
     short maxIncoming = 0;
 
     for(int d = 0; d < 6; d++)
@@ -1601,13 +1690,13 @@ void Chunk::refill_block_light(const glm::ivec3& pos, Chunk* neighbours[4])
         glm::ivec3 nb = pos + arrayOffset[d];
         short nbl = 0;
         if(is_valid_index(nb))
-            nbl = blockLights[lightIdx(nb.x, nb.y, nb.z)];
+            nbl = torch_at(lightIdx(nb.x, nb.y, nb.z));
         else
         {
             glm::ivec3 nbPos;
             int nbIdx = resolve_cross_chunk(nb, nbPos);
             if(nbIdx >= 0 && neighbours[nbIdx])
-                nbl = neighbours[nbIdx]->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)];
+                nbl = neighbours[nbIdx]->torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z));
         }
         short incoming = nbl - opacity;
         if(incoming > maxIncoming) maxIncoming = incoming;
@@ -1615,7 +1704,7 @@ void Chunk::refill_block_light(const glm::ivec3& pos, Chunk* neighbours[4])
 
     if(maxIncoming <= 0) return;
 
-    blockLights[lightIdx(pos.x, pos.y, pos.z)] = maxIncoming;
+    set_torch_at(lightIdx(pos.x, pos.y, pos.z), maxIncoming);
 
     // BFS 向外传播（与 update_light_on_create_luminous 相同模式）
     std::queue<glm::ivec3> lightBFS;
@@ -1626,20 +1715,20 @@ void Chunk::refill_block_light(const glm::ivec3& pos, Chunk* neighbours[4])
     {
         glm::ivec3 local = lightBFS.front();
         lightBFS.pop();
-        short localLight = blockLights[lightIdx(local.x, local.y, local.z)];
+        short localLight = torch_at(lightIdx(local.x, local.y, local.z));
 
         for(int d = 0; d < 6; ++d)
         {
             glm::ivec3 temp = local + arrayOffset[d];
             if(is_valid_index(temp))
             {
-                if(blockLights[lightIdx(temp.x, temp.y, temp.z)] >= localLight)
+                if(torch_at(lightIdx(temp.x, temp.y, temp.z)) >= localLight)
                     continue;
-                int dec = get_opacity(chunkBlocks[temp.x][temp.y][temp.z]);
+                int dec = get_opacity(block_at(temp.x, temp.y, temp.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                if(newLight <= blockLights[lightIdx(temp.x, temp.y, temp.z)]) continue;
-                blockLights[lightIdx(temp.x, temp.y, temp.z)] = newLight;
+                if(newLight <= torch_at(lightIdx(temp.x, temp.y, temp.z))) continue;
+                set_torch_at(lightIdx(temp.x, temp.y, temp.z), newLight);
                 lightBFS.push(temp);
             }
             else
@@ -1648,11 +1737,11 @@ void Chunk::refill_block_light(const glm::ivec3& pos, Chunk* neighbours[4])
                 int nbIdx = resolve_cross_chunk(temp, nbPos);
                 if(nbIdx < 0 || !neighbours[nbIdx]) continue;
                 Chunk* nb2 = neighbours[nbIdx];
-                int dec = get_opacity(nb2->chunkBlocks[nbPos.x][nbPos.y][nbPos.z]);
+                int dec = get_opacity(nb2->block_at(nbPos.x, nbPos.y, nbPos.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                if(newLight <= nb2->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)]) continue;
-                nb2->blockLights[lightIdx(nbPos.x, nbPos.y, nbPos.z)] = newLight;
+                if(newLight <= nb2->torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z))) continue;
+                nb2->set_torch_at(lightIdx(nbPos.x, nbPos.y, nbPos.z), newLight);
                 nbSeeds[nbIdx].push(nbPos);
             }
         }
@@ -1666,45 +1755,41 @@ void Chunk::refill_block_light(const glm::ivec3& pos, Chunk* neighbours[4])
         {
             glm::ivec3 local = nbSeeds[n].front();
             nbSeeds[n].pop();
-            short localLight = nb2->blockLights[lightIdx(local.x, local.y, local.z)];
+            short localLight = nb2->torch_at(lightIdx(local.x, local.y, local.z));
             for(int d = 0; d < 6; ++d)
             {
                 glm::ivec3 temp = local + arrayOffset[d];
                 if(!is_valid_index(temp)) continue;
-                if(nb2->blockLights[lightIdx(temp.x, temp.y, temp.z)] >= localLight) continue;
-                int dec = get_opacity(nb2->chunkBlocks[temp.x][temp.y][temp.z]);
+                if(nb2->torch_at(lightIdx(temp.x, temp.y, temp.z)) >= localLight) continue;
+                int dec = get_opacity(nb2->block_at(temp.x, temp.y, temp.z));
                 short newLight = localLight - dec;
                 if(newLight <= 0) continue;
-                if(newLight <= nb2->blockLights[lightIdx(temp.x, temp.y, temp.z)]) continue;
-                nb2->blockLights[lightIdx(temp.x, temp.y, temp.z)] = newLight;
+                if(newLight <= nb2->torch_at(lightIdx(temp.x, temp.y, temp.z))) continue;
+                nb2->set_torch_at(lightIdx(temp.x, temp.y, temp.z), newLight);
                 nbSeeds[n].push(temp);
             }
         }
-        nb2->lightUpdate = std::max(nb2->lightUpdate, VERTEX_ONLY);
+        nb2->mark_light_dirty(VERTEX_ONLY);
     }
 }
 
-void Chunk::create_tree(const glm::ivec3& pos)
+void Chunk::create_tree(const glm::ivec3& pos, int trunkHeight)
 {
-    // pos: 数组索引空间 (i, j, k)
-    // i ∈ [0, CHUNK_SIZE)  — Z轴反向
-    // j ∈ [0, CHUNK_SIZE)  — X轴
-    // k ∈ [0, CHUNK_HEIGHT) — Y轴（高度）
+    // pos: 数组索引空间 (i, j, k)，i、j 可以在区块之外（邻居的树），只放置落在本区块内的部分
+    // i — Z轴反向
+    // j — X轴
+    // k ∈ [0, CHUNK_HEIGHT) — Y轴（高度），树干顶部已由 plan_trees 保证留有树冠空间
     int ci = pos.x;
     int cj = pos.y;
     int ck = pos.z;
 
-    // 基于坐标的确定性哈希，生成树干高度 4~7
-    unsigned int seed = (unsigned int)(ci * 73856093u ^ cj * 19349663u ^ ck * 83492791u);
-    int trunkHeight = 4 + (seed % 4);
-
-    // 检查树干空间
-    if (ck + trunkHeight + 2 >= CHUNK_HEIGHT) return;
-
     // 放置树干
-    for (int h = 0; h < trunkHeight; h++)
+    if (ci >= 0 && ci < CHUNK_SIZE && cj >= 0 && cj < CHUNK_SIZE)
     {
-        chunkBlocks[ci][cj][ck + h] = WOOD;
+        for (int h = 0; h < trunkHeight; h++)
+        {
+            set_block_at(ci, cj, ck + h, WOOD);
+        }
     }
 
     // 树冠参数：树越高，树冠越大越厚
@@ -1772,9 +1857,9 @@ void Chunk::create_tree(const glm::ivec3& pos)
                 if (ni < 0 || ni >= CHUNK_SIZE || nj < 0 || nj >= CHUNK_SIZE) continue;
 
                 // 已有非空气方块则跳过
-                if (chunkBlocks[ni][nj][y] != AIR) continue;
+                if (block_at(ni, nj, y) != AIR) continue;
 
-                chunkBlocks[ni][nj][y] = LEAF;
+                set_block_at(ni, nj, y, LEAF);
             }
         }
     }
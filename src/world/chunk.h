@@ -5,13 +5,29 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "block.h"
+#include "block_storage.h"
+#include "chunk_section.h"
 #include "perlin_noise.h"
 #include "../render/basic_struct.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <queue>
 
 #define CHUNK_SIZE 32
 #define CHUNK_HEIGHT 128
+#define SECTION_HEIGHT 16                               // 垂直分段高度
+#define SECTION_SHIFT 4                                 // k >> SECTION_SHIFT 即分段编号
+#define SECTION_NUM (CHUNK_HEIGHT / SECTION_HEIGHT)     // 每个区块的分段数
+#define SECTION_MAX_QUADS (CHUNK_SIZE * CHUNK_SIZE * SECTION_HEIGHT * 6)   // 单个分段不透明面片数上限（每方块至多 6 面）
+#define SLICE_VOLUME (CHUNK_SIZE * CHUNK_SIZE * SECTION_HEIGHT)             // 单个分段的体素数
+#define SLICE_SHIFT 14                                                      // log2(SLICE_VOLUME)
+#define CAVE_LATTICE_XZ 1                               // 洞穴密度默认水平采样间隔（方块，1 为逐方块）
+#define CAVE_LATTICE_Y 1                                // 洞穴密度默认垂直采样间隔（方块，1 为逐方块）
+#define CLIMATE_CELL 8                                  // 气候噪声默认采样间隔（方块，1 为逐列计算、不使用瓦片缓存）
+#define WORLDGEN_VERSION 4                              // 世界生成算法版本：改变任一种子生成结果的修改须加一（存档记录该版本）
 
 // 区块光照更新等级（高级别包含低级别的全部操作）
 // NONE        : 无需更新
@@ -20,18 +36,109 @@
 // FULL_RESET  : 全量重算 = 重置 + 正向传播 + 刷新顶点
 enum LightUpdateLevel { NONE = 0, VERTEX_ONLY = 1, PROPAGATE = 2, FULL_RESET = 3 };
 
-// 邻居区块 mesh 更新等级
-// MESH_NONE           : 无需更新
-// MESH_BORDER_REFRESH : 仅重建边界面片（邻居方块变化导致边界面片需要更新）
-// MESH_FULL_REBUILD   : 完整重建所有面片（本区块方块变化）
-enum MeshUpdateLevel { MESH_NONE = 0, MESH_BORDER_REFRESH = 1, MESH_FULL_REBUILD = 2 };
+// 区块生命周期阶段（按顺序推进，记录已完成的最后一个阶段）
+// 方块、光照或 mesh 被标记为需要更新时，区块退回到需要重做的阶段之前（见 mark_light_dirty、mark_section_dirty）
+// 生成（ChunkGenerator 的工作线程）：
+// STAGE_TERRAIN       : 基础地形（岩层、土壤、水）
+// STAGE_CARVED        : 挖出洞穴，高度图确定，可以规划树木位置
+// STAGE_DECORATED     : 放置本区块与八个邻居的树木中落在本区块内的部分（需要邻居都已 STAGE_CARVED）；
+//                       方块已确定（Generated），从存档读回或有待处理的增量光照时也停在这里
+// STAGE_LIT           : 区块内部光照已计算（LocallyLit），生成完成，交给 Terrain
+// 之后由 Terrain 的 ChunkScheduler 在主线程推进：
+// STAGE_NEIGHBOUR_LIT : 已从四个邻居拉取边界光照（需要邻居都已 STAGE_LIT）
+// STAGE_MESHED        : 后台 mesh 构建完成，等待上传
+// STAGE_UPLOADED      : mesh 已写入显存池（没有需要绘制的分段时直接到达）
+// 已提交生成、区块尚不存在的 Requested 阶段由 ChunkScheduler 记录
+enum ChunkStage { STAGE_NONE = 0, STAGE_TERRAIN, STAGE_CARVED, STAGE_DECORATED, STAGE_LIT,
+                  STAGE_NEIGHBOUR_LIT, STAGE_MESHED, STAGE_UPLOADED, STAGE_COUNT };
+
+// 树木的根部位置（所在区块的数组坐标，k 为树干底部）与树干高度
+struct TreeRoot
+{
+    int i, j, k;
+    int trunkHeight;
+};
+
+struct ChunkMeshInput;
+struct ChunkMeshResult;
+class ClimateCache;
+class ChunkScheduler;
+
+// 地形生成参数（生成期间只读，所有生成线程共用）
+struct WorldGenSettings
+{
+    // 洞穴密度只在 caveLatticeXZ × caveLatticeY × caveLatticeXZ 的格点上采样噪声，格点之间三线性插值；
+    // 两者都为 1 时逐方块采样。洞穴噪声的特征尺寸只有约 10 格，插值抹掉了细窄的通道，间隔越大洞穴越小越圆滑：
+    // --bench-caves（种子 114514，256 个区块）中 2x2x2 快 1.6 倍、与逐方块结果的洞穴 IoU 为 0.84，
+    // 4x4x4 快 2.6 倍、IoU 只有 0.41，洞穴形状已明显不同，因此默认仍逐方块采样，粗格点只作为可选项。
+    // 间隔记入存档的生成器标识，改变间隔不会把编辑重放到不同的洞穴上
+    int caveLatticeXZ = CAVE_LATTICE_XZ;
+    int caveLatticeY = CAVE_LATTICE_Y;
+
+    // 大陆性与侵蚀度（低频气候噪声）的采样间隔，大于 1 时由 climate 指向的共享瓦片缓存插值
+    // 默认 8：插值误差平均约 0.1 格高度，相邻与并行生成的区块共用瓦片；间隔记入存档的生成器标识
+    int climateCell = CLIMATE_CELL;
+    ClimateCache* climate = nullptr;                    // 由 Terrain 按 climateCell 提供，为空时逐列计算
+
+    // 间隔取不超过给定值的 2 的幂，并限制在区块尺寸内（保证格点与区块边界对齐，相邻区块共用边界格点）
+    void set_cave_lattice(int xz, int y)
+    {
+        caveLatticeXZ = 1;
+        while(caveLatticeXZ * 2 <= std::min(xz, CHUNK_SIZE)) caveLatticeXZ *= 2;
+        caveLatticeY = 1;
+        while(caveLatticeY * 2 <= std::min(y, CHUNK_HEIGHT)) caveLatticeY *= 2;
+    }
+
+    // 同上取 2 的幂，不超过 64
+    void set_climate_cell(int cell)
+    {
+        climateCell = 1;
+        while(climateCell * 2 <= std::min(cell, 64)) climateCell *= 2;
+    }
+
+    // 存档头部记录的生成器标识：算法版本与改变地形的参数（各间隔的 log2）
+    // 标识不同的存档不能读取，否则编辑记录会重放到不同的地形上，保存的区块也会与新生成的邻居错位
+    uint32_t generator_id() const
+    {
+        auto log2 = [](int v) { uint32_t n = 0; while((2 << n) <= v) n++; return n; };
+        return ((uint32_t)WORLDGEN_VERSION << 16) | (log2(caveLatticeXZ) << 8) | (log2(caveLatticeY) << 4) | log2(climateCell);
+    }
+};
+
+// 一个分段（16 格高）的方块与光照
+// 区块与它拍摄的快照共享同一份 ChunkSlice；快照仍持有时，区块第一次写入该分段前先复制一份（写时复制），
+// 旧版本在最后一个快照释放时回收。
+struct ChunkSlice
+{
+    BlockStorage blocks;                                // 分段内方块，下标见 Chunk::sectionIdx
+    int nonAirCount = 0;                                // 非空气方块数量，0 表示全空气
+    uint8_t lights[SLICE_VOLUME];                       // 合并光照（高 4 位天空光，低 4 位方块光），下标同 blocks
+};
+
+// 区块某一时刻的只读快照：只增加各分段的引用计数，不拷贝数据
+// 快照可以交给任意线程读取（mesh 构建、保存、分析），期间区块照常修改
+struct ChunkSnapshot
+{
+    std::shared_ptr<const ChunkSlice> slices[SECTION_NUM];
+    std::shared_ptr<const std::vector<std::vector<int> > > heightMap;
+
+    // 数组索引空间的查询，与 Chunk::block_at 等同名函数一致
+    inline BLOCK_TYPE block_at(int i, int j, int k) const;
+    inline uint8_t light_at(int i, int j, int k) const;
+    bool is_empty(int s) const { return slices[s]->nonAirCount == 0; }
+
+    // 与 Chunk::serialize_blocks / serialize_lights 格式相同
+    void serialize_blocks(std::vector<uint8_t>& out) const;
+    void serialize_lights(std::vector<uint8_t>& out) const;
+};
 
 // ============ 坐标系映射说明 ============
 //
-// chunkBlocks[i][j][k] 的三个维度:
+// block_at(i, j, k) 的三个维度:
 //   i ∈ [0, CHUNK_SIZE)    — 对应 Z 轴（反向）
 //   j ∈ [0, CHUNK_SIZE)    — 对应 X 轴
 //   k ∈ [0, CHUNK_HEIGHT)  — 对应 Y 轴（高度）
+// 方块实际存放在 sections[k >> SECTION_SHIFT] 中，分段内下标为 sectionIdx(i, j, k)
 //
 // 数组索引 → mesh 局部坐标:
 //   mesh.x = j
@@ -57,49 +164,106 @@ enum MeshUpdateLevel { MESH_NONE = 0, MESH_BORDER_REFRESH = 1, MESH_FULL_REBUILD
 
 class Chunk
 {
+    // mesh 构建在工作线程上读取快照，需要共用坐标映射与面片常量
+    friend class ChunkMesher;
+    friend struct ChunkSnapshot;
+
     private:
-        std::vector<std::vector<std::vector<BLOCK_TYPE> > > chunkBlocks;
-        std::vector<std::vector<int> > heightMap;
-        std::vector<Vertex> vertices;
-        std::vector<Vertex> verticesT;              // 透明方块顶点数据
-        std::vector<glm::vec3> transparentFaceCenters; // 每个透明面片的中心（chunk局部空间）
-        std::vector<short> skyLights, blockLights;
-
-        // 一维索引：skyLights[i][j][k] → skyLights[lightIdx(i,j,k)]
+        // 生成（或读取）后不再修改，快照直接共享
+        std::shared_ptr<std::vector<std::vector<int> > > heightMap;
+        // 各分段的方块与光照（写时复制，见 ChunkSlice）
+        std::shared_ptr<ChunkSlice> slices[SECTION_NUM];
+
+        // 分段内一维索引：k 取分段内的相对高度
+        static inline int sectionIdx(int i, int j, int k) {
+            return i * (CHUNK_SIZE * SECTION_HEIGHT) + j * SECTION_HEIGHT + (k & (SECTION_HEIGHT - 1));
+        }
+
+        // 光照一维索引：高位为分段编号，低 SLICE_SHIFT 位为分段内下标
         static inline int lightIdx(int i, int j, int k) {
+            return ((k >> SECTION_SHIFT) << SLICE_SHIFT) | sectionIdx(i, j, k);
+        }
+
+        // 编辑记录使用的体素下标（与分段划分无关，保证存档格式稳定）
+        static inline int voxelIdx(int i, int j, int k) {
             return i * (CHUNK_SIZE * CHUNK_HEIGHT) + j * CHUNK_HEIGHT + k;
         }
 
-        // 预计算纹理坐标以减少函数调用
-        glm::vec2* sideTexCoords; // 存储方块的侧面纹理坐标
-        glm::vec2* topTexCoords;  // 存储方块的顶部纹理坐标
-        glm::vec2* bottomTexCoords; // 存储方块的底部纹理坐标
+        // 取得可写的分段：仍被快照引用时先复制一份
+        // 快照只在区块所属线程上拍摄，其他线程只会释放引用，因此引用计数为 1 时不会有新的读者。
+        // use_count() 是 relaxed 读取，与工作线程释放快照时的递减之间没有同步关系，
+        // 原地写入前需要 acquire 栅栏，保证该线程释放前对分段的读取都已完成（shared_ptr::unique 被弃用的原因）
+        inline ChunkSlice& write_slice(int s) {
+            if(slices[s].use_count() != 1)
+                slices[s] = std::make_shared<ChunkSlice>(*slices[s]);
+            else
+                std::atomic_thread_fence(std::memory_order_acquire);
+            return *slices[s];
+        }
+
+        // 按一维索引读写光照的两个半字节（写入值须在 [0, 15] 内）
+        inline uint8_t light_at(int idx) const { return slices[idx >> SLICE_SHIFT]->lights[idx & (SLICE_VOLUME - 1)]; }
+        inline short sky_at(int idx) const { return light_at(idx) >> 4; }
+        inline short torch_at(int idx) const { return light_at(idx) & 0x0F; }
+        inline void set_sky_at(int idx, int value) {
+            uint8_t& light = write_slice(idx >> SLICE_SHIFT).lights[idx & (SLICE_VOLUME - 1)];
+            light = (uint8_t)((light & 0x0F) | (value << 4));
+        }
+        inline void set_torch_at(int idx, int value) {
+            uint8_t& light = write_slice(idx >> SLICE_SHIFT).lights[idx & (SLICE_VOLUME - 1)];
+            light = (uint8_t)((light & 0xF0) | value);
+        }
+
+        // 数组索引空间的方块读写（mesh 构建与光照 BFS 统一经由此访问）
+        inline BLOCK_TYPE block_at(int i, int j, int k) const {
+            return slices[k >> SECTION_SHIFT]->blocks.get(sectionIdx(i, j, k));
+        }
+        inline void set_block_at(int i, int j, int k, BLOCK_TYPE blockType) {
+            ChunkSlice& slice = write_slice(k >> SECTION_SHIFT);
+            int idx = sectionIdx(i, j, k);
+            BLOCK_TYPE oldType = slice.blocks.get(idx);
+            slice.blocks.set(idx, blockType);
+            slice.nonAirCount += (blockType != AIR) - (oldType != AIR);
+        }
+
+        // 为每个分段分配空的存储（全空气、光照为 0）
+        void init_slices();
+
+        // 最高的非空分段编号（全空气区块返回 -1）
+        // 其上方的分段全为空气，天空光恒为 15
+        int top_solid_section() const;
 
         // 六个面的顶点偏移和法线（相对于方块原点 (xPos, yPos, zPos)）
         // 顺序：Back(i-1), Forward(i+1), Left(j-1), Right(j+1), Down(k-1), Up(k+1)
         static const glm::vec3 faceVertexOffset[6][4];
         static const glm::vec3 faceNormal[6];
 
-        void create_face(Vertex& vertex1, Vertex& vertex2, Vertex& vertex3, Vertex& vertex4);
-        void create_face_transparent(Vertex& vertex1, Vertex& vertex2, Vertex& vertex3, Vertex& vertex4);
+        // 拷贝一条边界（一层方块与光照）供邻居构建 mesh，下标 p * CHUNK_HEIGHT + k
+        // side: 0=j=0(left), 1=j=max(right), 2=i=max(forward), 3=i=0(back)
+        void export_border(int side, BLOCK_TYPE* blocks, uint8_t* borderLights) const;
 
-        void upload_data();
-        void upload_data_transparent();
-        void upload_border_data();
-        void upload_border_data_transparent();
+        // 标记分段 mesh 需要更新（同时汇总到区块级 meshUpdate），生命周期退回 STAGE_NEIGHBOUR_LIT
+        void mark_section_dirty(int s, MeshUpdateLevel level);
 
-        BLOCK_TYPE get_neighbor_block(int i, int j, int k, int face,
-            const Chunk* neighbours[4]) const;
+        // 生命周期退回到 target（已在其之前时不变），并通知调度器重新推进本区块
+        void lower_stage(ChunkStage target);
 
-        // 获取相邻方块的合并光照：编码为 skyLight + blockLight / 16.0
-        // 一次遍历同时读取 skyLights 和 blockLights，避免双倍查询开销
-        float get_neighbor_combined_light(int i, int j, int k, int face,
+        // 加载窗口内的区块挂接的调度器与本区块的索引（见 attach_scheduler），其余区块为空
+        ChunkScheduler* scheduler = nullptr;
+        std::pair<int, int> schedulerIndex;
+
+        // 获取相邻方块的光照字节（高 4 位天空光，低 4 位方块光，与 TerrainVertex 中的编码一致）
+        // 一次邻居定位同时读取天空光与方块光，避免双倍查询开销
+        uint8_t get_neighbor_light(int i, int j, int k, int face,
             const Chunk* neighbours[4]) const;
 
         // 光照 BFS 的通用传播函数（阶段一和阶段二共用）
         void update_block_light(std::queue<glm::ivec3>& lightBFS);
 
-        // 增量天空光更新（仅修改本区块 skyLights，不跨区块）
+        // 方块光 BFS：从队列中的格子向外传播，只在本区块内（跨边界的部分由邻居在 update_chunk_light 中拉取）
+        void update_torch_light(std::queue<glm::ivec3>& lightBFS);
+
+        // 增量天空光更新（仅修改本区块天空光，不跨区块）
         void update_light_on_destroy(const glm::ivec3& pos);
         void update_light_on_create(const glm::ivec3& pos);
 
@@ -108,8 +272,8 @@ class Chunk
         void update_light_on_destory_luminous(const glm::ivec3& pos, Chunk* neighbours[4]);
         void refill_block_light(const glm::ivec3& pos, Chunk* neighbours[4]);
 
-        // 在指定位置生成一棵树（pos 为数组索引空间）
-        void create_tree(const glm::ivec3& pos);
+        // 在指定位置生成一棵树（pos 为数组索引空间，可在区块之外，只放置落在本区块内的部分）
+        void create_tree(const glm::ivec3& pos, int trunkHeight);
 
         // 邻居边界增量光照移除（放置方块时替代 init_local_light）
         // side: 0=j=0(left), 1=j=max(right), 2=i=max(forward), 3=i=0(back)
@@ -121,64 +285,113 @@ class Chunk
         // 数组空间的六邻居偏移 [i][j][k] 对应 [Z反向][X][Y高度]
         static const glm::ivec3 arrayOffset[6];
 
-        // 法线向量 → 面索引 (0~5)
-        static int normal_to_face(const glm::vec3& normal);
-
         // 判断 (i,j) 的第 face 面是否跨越区块边界
         static bool is_border_face(int i, int j, int face);
 
-        // 内部/边界面片分割点（update_data 两趟之间记录）
-        size_t borderVertexStart = 0;
-        size_t borderIndexStart = 0;
-        size_t borderVertexTStart = 0;
-        size_t borderIndexTStart = 0;
-        size_t borderFaceCenterStart = 0;
-
     public:
-        std::vector<unsigned int> indices;
-        std::vector<unsigned int> indicesT;                 // 透明方块索引数据
-        unsigned int EBO = 0, VAO = 0, VBO = 0;
-        unsigned int transparentEBO = 0, transparentVAO = 0, transparentVBO = 0;
-        MeshUpdateLevel meshUpdate = MESH_NONE;              // 区块 mesh 更新等级
+        ChunkSection sections[SECTION_NUM];                 // 垂直分段（自底向上）
+        MeshUpdateLevel meshUpdate = MESH_NONE;              // 区块 mesh 更新等级（各分段的汇总）
         LightUpdateLevel lightUpdate = NONE;                // 区块光照更新等级
+        bool modified = false;                              // 生成（或上次保存）后是否被玩家编辑过
+        bool persisted = false;                             // 区域文件中已有该区块的记录
+        std::vector<uint32_t> edits;                        // 玩家编辑记录 (voxelIdx << 8 | 方块类型)，按下标升序，同一位置只保留最新值
         struct PendingLight { glm::ivec3 pos; bool isDestroy; };
         std::vector<PendingLight> pendingLightUpdates;
+        ChunkStage stage = STAGE_NONE;                      // 已完成的生成阶段
+
+        // 标记光照需要更新，生命周期退回到需要重做的阶段：
+        // FULL_RESET → STAGE_DECORATED（重算内部光照），PROPAGATE → STAGE_LIT（重新拉取邻居光照），VERTEX_ONLY → STAGE_NEIGHBOUR_LIT
+        void mark_light_dirty(LightUpdateLevel level);
 
-        Chunk(): VAO(0), VBO(0), EBO(0), transparentVAO(0), transparentVBO(0), transparentEBO(0){};
+        // 区块进入加载窗口时由 Terrain 挂接调度器：此后编辑方块、邻居失效与光照例程标记更新时，
+        // 区块把自己的索引放入调度器的待推进队列；移出窗口时挂接 nullptr
+        void attach_scheduler(ChunkScheduler* owner, const std::pair<int, int>& index) { scheduler = owner; schedulerIndex = index; }
 
-        Chunk(PerlinNoise& perlinNoise, int x, int y);
+        // 区块只保存方块、光照与 CPU mesh，不持有也不调用任何 GL 资源，可在任意线程创建、移动和销毁；
+        // 显存区间由 Terrain 按区块索引保存在 ChunkRenderData 中，按下面各函数返回的分段掩码上传
+        Chunk(){};
+
+        // 分阶段生成（见 ChunkStage），须在默认构造的空区块上依次调用，各阶段只写本区块
+        // 装饰阶段需要八个邻居的树木，生成区块请交给 ChunkGenerator（单个区块用 generate_now，邻居可以复用）
+        void generate_terrain(PerlinNoise& perlinNoise, int x, int y, const WorldGenSettings& settings);
+        void carve_caves(PerlinNoise& perlinNoise, int x, int y, const WorldGenSettings& settings);
+
+        // 由挖好洞穴的区块确定本区块的树木（只读，结果只取决于种子与区块坐标）
+        void plan_trees(PerlinNoise& perlinNoise, int x, int y, std::vector<TreeRoot>& roots) const;
+
+        // area[(dz+1)*3 + (dx+1)] 为区块 (x+dx, y+dz) 的树木，可为空
+        void decorate(const std::vector<TreeRoot>* area[9]);
+
+        // 重放编辑记录、计算区块内部光照并标记 mesh 需要构建
+        void finish_generation(const std::vector<uint32_t>* replay);
 
         int get_height(int i, int j) const
         {
-            return heightMap[CHUNK_SIZE-1-j][i];
+            return (*heightMap)[CHUNK_SIZE-1-j][i];
         }
 
         BLOCK_TYPE get_block_type(int i, int j, int k) const
         {
-            return chunkBlocks[CHUNK_SIZE-1-j][i][k];
+            return block_at(CHUNK_SIZE-1-j, i, k);
         }
 
+        // 拍摄只读快照（只增加引用计数），必须在区块所属线程调用
+        ChunkSnapshot snapshot() const;
+
+        // 分段是否全为空气
+        bool is_section_empty(int s) const { return slices[s]->nonAirCount == 0; }
+
+        // 为脏分段拍摄 mesh 构建快照（本区块全部方块与光照 + 四个邻居的边界），并清除脏标记
+        // 快照交给 ChunkMesher 在工作线程构建，分段按各自的更新等级完整重建或仅刷新边界
         // neighbours[4] 顺序: {left(-X), right(+X), forward(-Z), back(+Z)}
-        void update_data(const Chunk* neighbours[4]);
+        void make_mesh_input(const Chunk* neighbours[4], ChunkMeshInput& input);
+
+        // 用工作线程构建的 mesh 替换分段的 CPU mesh，返回被替换的分段掩码（第 s 位对应分段 s，须重新上传）
+        unsigned int apply_mesh(ChunkMeshResult& result);
 
-        void sort_transparent_faces(const glm::vec3& localCameraPos);
+        // 清空 CPU mesh（调用方先归还对应的渲染资源），重新进入时完整重建 mesh 并重新拉取邻居光照
+        void release_meshes();
 
-        // 仅重建边界面片（内部面片不动），用于邻居方块变化时的轻量更新
-        void refresh_border_mesh(const Chunk* neighbours[4]);
+        // CPU 端占用的字节数（方块存储 + 光照 + mesh 顶点/索引），用于统计（与快照共享的分段同样计入）
+        size_t memory_usage() const;
+
+        // 是否有分段持有 CPU mesh（即上传过的非空 mesh）
+        bool has_mesh() const;
+
+        // 序列化方块数据：高度图 + 各分段 [非空气数][调色板压缩方块]，不含光照与 mesh
+        void serialize_blocks(std::vector<uint8_t>& out) const;
+
+        // 由 serialize_blocks 的数据恢复区块（须为默认构造的空区块），光照与 mesh 标记为全量重建
+        bool deserialize_blocks(const uint8_t* data, size_t size);
+
+        // 光照按 [值][连续长度] 游程编码（大片天空光与地下全暗压缩率很高）
+        void serialize_lights(std::vector<uint8_t>& out) const;
+
+        // 恢复 serialize_lights 写出的光照。保存之后邻居可能已改变（如拆除了照进本区块的火把），
+        // 成功后四条边界的天空光先增量移除再与邻居重新传播，方块光按本区块的发光方块重算后再拉取邻居的部分
+        bool deserialize_lights(const uint8_t* data, size_t size);
+
+        // 需要写入区域文件（从未保存，或保存后又被编辑）
+        bool needs_save() const { return modified || !persisted; }
 
         bool set_block(int x, int y, int z, BLOCK_TYPE blockType, Chunk* neighbours[4]);
 
         double generate_height(PerlinNoise& perlinNoise, double x, double z);
 
+        // 一次计算一行 CHUNK_SIZE 列的 generate_height(x + j, z)（批量噪声）
+        // climate 非空时大陆性与侵蚀度由瓦片缓存插值（x、z 须为整数坐标）
+        void generate_height_row(PerlinNoise& perlinNoise, double x, double z, double* out, ClimateCache* climate = nullptr);
+
         // 光照系统
         static bool is_valid_index(const glm::ivec3& index);
         short get_block_light(const glm::ivec3& index) const;      // 天空光查询
         short get_torch_light(const glm::ivec3& index) const;      // 方块光查询（火把等）
         void init_local_light();                          // 阶段一：区块内部光照
+        void init_torch_light();                          // 阶段一：区块内部方块光（所有发光方块一次播种）
         void update_chunk_light(const Chunk* neighbours[4]); // 阶段二：跨区块边界传播
 
-        // 仅刷新顶点的 LightLevel 并重传 VBO（不重建几何）
-        void refresh_vertex_lights(const Chunk* neighbours[4]);
+        // 仅刷新 CPU mesh 顶点的光照字节（不重建几何），返回顶点被改写的分段掩码（须重新上传）
+        unsigned int refresh_vertex_lights(const Chunk* neighbours[4]);
 
         // 处理增量光照更新队列（block pending + boundary removal）
         void process_pending_lights();
@@ -197,22 +410,19 @@ class Chunk
         Chunk(Chunk&& other) noexcept;
         Chunk& operator=(Chunk&& other) noexcept;
 
-        ~Chunk()
-        {
-            // 释放前检查ID是否有效（0是安全的，glDelete会忽略）
-            if (VAO != 0) glDeleteVertexArrays(1, &VAO);
-            if (VBO != 0) glDeleteBuffers(1, &VBO);
-            if (EBO != 0) glDeleteBuffers(1, &EBO);
-            if (transparentVAO != 0) glDeleteVertexArrays(1, &transparentVAO);
-            if (transparentVBO != 0) glDeleteBuffers(1, &transparentVBO);
-            if (transparentEBO != 0) glDeleteBuffers(1, &transparentEBO);
-
-            delete[] sideTexCoords;
-            delete[] topTexCoords;
-            delete[] bottomTexCoords;
-        }
+        ~Chunk() {}
 };
 
+inline BLOCK_TYPE ChunkSnapshot::block_at(int i, int j, int k) const
+{
+    return slices[k >> SECTION_SHIFT]->blocks.get(Chunk::sectionIdx(i, j, k));
+}
+
+inline uint8_t ChunkSnapshot::light_at(int i, int j, int k) const
+{
+    return slices[k >> SECTION_SHIFT]->lights[Chunk::sectionIdx(i, j, k)];
+}
+
 // 样条曲线：将 [-1,1] 的 continental 值映射到合理的基础高度
 double spline_map_continental(double c);
 
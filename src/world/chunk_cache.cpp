@@ -0,0 +1,121 @@
+#include "chunk_cache.h"
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+void ChunkCache::open_spill(const char* path)
+{
+    close_spill();
+    spillPath = path;
+    spillFile.open(path, ios::in | ios::out | ios::binary | ios::trunc);
+    spillEnd = 0;
+}
+
+void ChunkCache::close_spill()
+{
+    if(spillFile.is_open())
+    {
+        spillFile.close();
+        remove(spillPath.c_str());
+    }
+    spilled.clear();
+    spillEnd = 0;
+}
+
+Chunk* ChunkCache::find(const ChunkIndex& index)
+{
+    auto it = entries.find(index);
+    if(it == entries.end()) return nullptr;
+
+    // 移到表头，并按当前内容更新占用（访问期间可能被编辑）
+    lru.splice(lru.begin(), lru, it->second);
+    Entry& entry = *it->second;
+    cachedBytes -= entry.bytes;
+    entry.bytes = entry.chunk->memory_usage();
+    cachedBytes += entry.bytes;
+    return entry.chunk.get();
+}
+
+Chunk* ChunkCache::peek(const ChunkIndex& index) const
+{
+    auto it = entries.find(index);
+    return it != entries.end() ? it->second->chunk.get() : nullptr;
+}
+
+Chunk* ChunkCache::put(const ChunkIndex& index, unique_ptr<Chunk> chunk)
+{
+    auto it = entries.find(index);
+    if(it != entries.end())
+        erase(it->second);
+    size_t bytes = chunk->memory_usage();
+    lru.push_front({index, std::move(chunk), bytes});
+    entries[index] = lru.begin();
+    cachedBytes += bytes;
+    return lru.front().chunk.get();
+}
+
+unique_ptr<Chunk> ChunkCache::take(const ChunkIndex& index)
+{
+    auto it = entries.find(index);
+    if(it == entries.end()) return nullptr;
+    unique_ptr<Chunk> chunk = std::move(it->second->chunk);
+    erase(it->second);
+    return chunk;
+}
+
+void ChunkCache::erase(list<Entry>::iterator it)
+{
+    cachedBytes -= it->bytes;
+    entries.erase(it->index);
+    lru.erase(it);
+}
+
+bool ChunkCache::spill(const ChunkIndex& index, const Chunk& chunk)
+{
+    if(!spillFile.is_open()) return false;
+    vector<uint8_t> data;
+    chunk.serialize_blocks(data);
+
+    // 只追加写入：重复溢出的区块以最新记录为准，旧记录作废（文件只在本次运行中使用）
+    spillFile.seekp(spillEnd);
+    spillFile.write((const char*)data.data(), (streamsize)data.size());
+    if(!spillFile)
+    {
+        spillFile.clear();
+        return false;
+    }
+    spilled[index] = {spillEnd, (uint32_t)data.size()};
+    spillEnd += (streamoff)data.size();
+    return true;
+}
+
+unique_ptr<Chunk> ChunkCache::restore(const ChunkIndex& index)
+{
+    auto it = spilled.find(index);
+    if(it == spilled.end()) return nullptr;
+
+    vector<uint8_t> data(it->second.second);
+    spillFile.seekg(it->second.first);
+    spillFile.read((char*)data.data(), (streamsize)data.size());
+    if(!spillFile)
+    {
+        spillFile.clear();
+        return nullptr;
+    }
+
+    // 读回并解析成功后才丢弃溢出记录，失败时保留（记录是编辑过的区块的唯一副本）
+    unique_ptr<Chunk> chunk = make_unique<Chunk>();
+    if(!chunk->deserialize_blocks(data.data(), data.size()))
+        return nullptr;
+    spilled.erase(it);
+    chunk->modified = true;
+    return chunk;
+}
+
+void ChunkCache::clear()
+{
+    lru.clear();
+    entries.clear();
+    cachedBytes = 0;
+}
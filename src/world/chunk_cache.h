@@ -0,0 +1,145 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include "chunk.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#define CHUNK_SPILL_FILE "./chunk_spill.bin"            // 被淘汰的已编辑区块的溢出文件（仅本次运行有效，退出时删除）
+
+// 加载窗口外区块的 LRU 缓存
+//
+// 区块离开 ChunkGrid 窗口后先放入缓存，连同 mesh 一起保留（Terrain 按索引持有的渲染资源也随之保留）：
+// 玩家在窗口边界来回移动时区块直接回到网格，无需重新生成或构建 mesh。超出预算时由 Terrain 按最久未使用的顺序淘汰：
+//   release_lru_mesh() 先归还显存（保留方块与光照，重新进入时完整重建 mesh）
+//   drop_lru()         再释放整个区块，释放前由调用方保存（写入存档，或把编辑过的区块 spill() 到溢出文件，
+//                      重新访问时由 restore() 读回）并归还其渲染资源
+// 缓存本身不接触 GL，渲染资源的归还经回调交给 Terrain。
+// 距窗口中心 keepRadius（切比雪夫距离）以内的区块不参与淘汰，作为加载/卸载之间的滞回带。
+class ChunkCache
+{
+    public:
+        typedef std::pair<int, int> ChunkIndex;
+
+    private:
+        struct Entry
+        {
+            ChunkIndex index;
+            std::unique_ptr<Chunk> chunk;
+            size_t bytes;                               // 放入或最近一次访问时的 CPU 占用
+        };
+        std::list<Entry> lru;                           // 表头为最近使用
+        std::map<ChunkIndex, std::list<Entry>::iterator> entries;
+        size_t cachedBytes = 0;                         // 缓存中区块的 CPU 占用合计
+
+        std::string spillPath;
+        std::fstream spillFile;
+        std::map<ChunkIndex, std::pair<std::streamoff, uint32_t>> spilled;  // 区块 → 溢出文件中的 (偏移, 长度)
+        std::streamoff spillEnd = 0;
+
+        // 从表尾向前找第一个满足 pred 且在 keepRadius 之外的条目
+        template<class Pred> std::list<Entry>::iterator find_lru(int cx, int cz, int keepRadius, Pred pred)
+        {
+            for(auto it = lru.end(); it != lru.begin(); )
+            {
+                --it;
+                int dist = std::max(std::abs(it->index.first - cx), std::abs(it->index.second - cz));
+                if(dist > keepRadius && pred(*it->chunk))
+                    return it;
+            }
+            return lru.end();
+        }
+
+        void erase(std::list<Entry>::iterator it);
+
+    public:
+        ChunkCache(){};
+
+        ~ChunkCache()
+        {
+            close_spill();
+        }
+
+        // 创建溢出文件（已存在则清空）
+        void open_spill(const char* path);
+
+        // 关闭并删除溢出文件（其中的区块随之丢弃）
+        void close_spill();
+
+        // 查找缓存中的区块并标记为最近使用
+        Chunk* find(const ChunkIndex& index);
+
+        // 查找但不改变 LRU 顺序（上传 mesh 等内部访问）
+        Chunk* peek(const ChunkIndex& index) const;
+
+        // 放入区块（作为最近使用），返回放入后的指针
+        Chunk* put(const ChunkIndex& index, std::unique_ptr<Chunk> chunk);
+
+        // 取出区块（不在缓存中时返回空）
+        std::unique_ptr<Chunk> take(const ChunkIndex& index);
+
+        // 把区块方块数据追加到溢出文件，写入失败返回 false
+        bool spill(const ChunkIndex& index, const Chunk& chunk);
+
+        // 区块是否已溢出到磁盘
+        bool is_spilled(const ChunkIndex& index) const { return spilled.count(index) > 0; }
+
+        // 从溢出文件读回区块，成功读回后不再占用溢出记录；读取或解析失败返回空，记录保留
+        std::unique_ptr<Chunk> restore(const ChunkIndex& index);
+
+        // 丢弃 keepRadius 之外最久未使用、且仍持有 mesh 的区块的 mesh：先调用 release(const ChunkIndex&)
+        // 归还其渲染资源（返回归还的顶点数），再清空 CPU mesh；返回归还的顶点数（没有可归还的返回 0）
+        template<class Release> unsigned int release_lru_mesh(int cx, int cz, int keepRadius, Release release)
+        {
+            auto it = find_lru(cx, cz, keepRadius, [](const Chunk& chunk) { return chunk.has_mesh(); });
+            if(it == lru.end()) return 0;
+
+            unsigned int released = release(it->index);
+            it->chunk->release_meshes();
+            cachedBytes -= it->bytes;
+            it->bytes = it->chunk->memory_usage();
+            cachedBytes += it->bytes;
+            return released;
+        }
+
+        // 释放 keepRadius 之外最久未使用的区块，没有可释放的返回 false
+        // 释放前调用 persist(const ChunkIndex&, Chunk&) 保存并归还渲染资源，其返回 false 时区块留在内存中（避免丢失修改）
+        template<class Persist> bool drop_lru(int cx, int cz, int keepRadius, Persist persist)
+        {
+            auto it = find_lru(cx, cz, keepRadius, [](const Chunk&) { return true; });
+            if(it == lru.end()) return false;
+
+            if(!persist(it->index, *it->chunk))
+            {
+                lru.splice(lru.begin(), lru, it);
+                return false;
+            }
+            erase(it);
+            return true;
+        }
+
+        // 遍历缓存中的区块：f(const ChunkIndex&, Chunk&)
+        template<class F> void for_each(F f)
+        {
+            for(Entry& entry : lru)
+                f(entry.index, *entry.chunk);
+        }
+
+        // 释放全部区块（不溢出，渲染资源由 Terrain 另行归还）
+        void clear();
+
+        size_t size() const { return lru.size(); }
+        size_t memory_usage() const { return cachedBytes; }
+        size_t spilled_count() const { return spilled.size(); }
+
+        ChunkCache(const ChunkCache&) = delete;
+        ChunkCache& operator=(const ChunkCache&) = delete;
+};
+
+#endif
@@ -0,0 +1,365 @@
+#include "chunk_generator.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+void ChunkGenerator::start(PerlinNoise* noise, const WorldGenSettings* genSettings, RegionStore* regionStore,
+                           DeltaStore* deltaStore, int threadCount)
+{
+    stop();
+    perlinNoise = noise;
+    settings = genSettings;
+    store = regionStore;
+    deltas = deltaStore;
+    if(threadCount <= 0)
+    {
+        int hw = (int)std::thread::hardware_concurrency();
+        threadCount = std::max(1, std::min(hw - 1, 4));
+    }
+    for(int t = 0; t < threadCount; t++)
+        workers.emplace_back(&ChunkGenerator::worker_loop, this);
+}
+
+void ChunkGenerator::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for(std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = false;
+    protos.clear();
+    finished.clear();
+}
+
+bool ChunkGenerator::job_for(const ChunkIndex& index, Proto& proto, Job& job)
+{
+    if(proto.busy) return false;
+    job.index = index;
+    job.planRoots = false;
+    if(proto.requested && !proto.storeChecked && store)
+    {
+        job.stage = STAGE_NONE;
+        return true;
+    }
+    if(!proto.requested && !(proto.rootsWanted && !proto.rootsReady))
+        return false;
+
+    ChunkStage stage = proto.chunk ? proto.chunk->stage : STAGE_NONE;
+    if(stage == STAGE_NONE)
+        job.stage = STAGE_TERRAIN;
+    else if(stage == STAGE_TERRAIN)
+    {
+        job.stage = STAGE_CARVED;
+        job.planRoots = !proto.rootsReady;
+    }
+    else if(!proto.requested)
+        return false;
+    else if(stage == STAGE_CARVED)
+    {
+        // 八个邻居都规划好树木才能装饰；缺少的登记为需要，优先级随本区块
+        bool ready = true;
+        for(int dz = -1; dz <= 1; dz++)
+        {
+            for(int dx = -1; dx <= 1; dx++)
+            {
+                if(dx == 0 && dz == 0) continue;
+                ChunkIndex neighbour(index.first + dx, index.second + dz);
+                auto it = protos.find(neighbour);
+                if(it == protos.end())
+                {
+                    it = protos.emplace(neighbour, Proto()).first;
+                    it->second.priority = proto.priority;
+                }
+                Proto& n = it->second;
+                if(n.rootsReady) continue;
+                if(!n.rootsWanted || proto.priority < n.priority)
+                    n.priority = proto.priority;
+                if(!n.rootsWanted)
+                    expanded = true;
+                n.rootsWanted = true;
+                ready = false;
+            }
+        }
+        if(!ready) return false;
+        job.stage = STAGE_DECORATED;
+    }
+    else if(stage == STAGE_DECORATED)
+        job.stage = STAGE_LIT;
+    else
+        return false;
+    return true;
+}
+
+bool ChunkGenerator::pick_job(Job& job, const ChunkIndex* near)
+{
+    // 取优先级数值最小的任务；流水线中的区块数量与加载范围同阶，线性扫描即可
+    Proto* best = nullptr;
+    Job candidate;
+    auto consider = [&](const ChunkIndex& index, Proto& proto) {
+        if((!best || proto.priority < best->priority) && job_for(index, proto, candidate))
+        {
+            best = &proto;
+            job.index = candidate.index;
+            job.stage = candidate.stage;
+            job.planRoots = candidate.planRoots;
+        }
+    };
+    // 扫描中新登记的邻居可能排在已扫过的位置，没有找到任务时再扫一遍
+    do
+    {
+        expanded = false;
+        if(near)
+        {
+            for(int dz = -1; dz <= 1; dz++)
+            {
+                for(int dx = -1; dx <= 1; dx++)
+                {
+                    auto it = protos.find({near->first + dx, near->second + dz});
+                    if(it != protos.end())
+                        consider(it->first, it->second);
+                }
+            }
+        }
+        else
+        {
+            for(auto& p : protos)
+                consider(p.first, p.second);
+        }
+    } while(!best && expanded);
+    if(!best) return false;
+
+    // 读取存档不改动流水线中的区块，其余阶段在执行期间取走区块
+    best->busy = true;
+    if(job.stage != STAGE_NONE)
+        job.chunk = std::move(best->chunk);
+    if(job.stage == STAGE_DECORATED)
+    {
+        // 复制 3×3 范围内的树木位置，执行期间不再访问邻居
+        for(int dz = -1; dz <= 1; dz++)
+        {
+            for(int dx = -1; dx <= 1; dx++)
+                job.area[(dz+1)*3 + (dx+1)] = protos[{job.index.first + dx, job.index.second + dz}].treeRoots;
+        }
+    }
+    return true;
+}
+
+void ChunkGenerator::run_job(Job& job)
+{
+    int x = job.index.first, z = job.index.second;
+    switch(job.stage)
+    {
+        case STAGE_NONE:
+            job.chunk = store->load_chunk(job.index);
+            break;
+        case STAGE_TERRAIN:
+            job.chunk = std::make_unique<Chunk>();
+            job.chunk->generate_terrain(*perlinNoise, x, z, *settings);
+            break;
+        case STAGE_CARVED:
+            job.chunk->carve_caves(*perlinNoise, x, z, *settings);
+            if(job.planRoots)
+                job.chunk->plan_trees(*perlinNoise, x, z, job.roots);
+            break;
+        case STAGE_DECORATED:
+        {
+            const std::vector<TreeRoot>* area[9];
+            for(int n = 0; n < 9; n++)
+                area[n] = &job.area[n];
+            job.chunk->decorate(area);
+            break;
+        }
+        case STAGE_LIT:
+        {
+            std::vector<uint32_t> edits;
+            bool replay = deltas && deltas->edits_of(job.index, edits);
+            job.chunk->finish_generation(replay ? &edits : nullptr);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void ChunkGenerator::finish_job(Job& job)
+{
+    // 执行中的区块不会被移除
+    Proto& proto = protos[job.index];
+    proto.busy = false;
+
+    if(job.stage == STAGE_NONE)
+    {
+        // 存档中有记录：直接交出，流水线中已生成的阶段留给邻居使用
+        proto.storeChecked = true;
+        if(job.chunk && proto.requested && !stopping)
+        {
+            finished.emplace_back(job.index, std::move(job.chunk));
+            proto.requested = false;
+        }
+        return;
+    }
+
+    if(job.stage == STAGE_CARVED && job.planRoots)
+    {
+        proto.treeRoots = std::move(job.roots);
+        proto.rootsReady = true;
+    }
+    if(job.stage == STAGE_LIT && proto.requested && !proto.sync)
+    {
+        if(!stopping)
+            finished.emplace_back(job.index, std::move(job.chunk));
+        proto.requested = false;
+        return;
+    }
+    // 只为邻居提供树木位置的区块不再需要方块数据
+    if(!proto.requested && !proto.sync && proto.rootsReady && job.chunk->stage == STAGE_CARVED)
+        return;
+    proto.chunk = std::move(job.chunk);
+}
+
+void ChunkGenerator::worker_loop()
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&]{ return stopping || pick_job(job, nullptr); });
+            if(stopping) return;
+        }
+
+        run_job(job);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            finish_job(job);
+        }
+        // 完成的阶段可能让其他区块（邻居的装饰、generate_now）可以继续
+        cv.notify_all();
+    }
+}
+
+void ChunkGenerator::request(const ChunkIndex& index, int priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for(auto& done : finished)
+        {
+            if(done.first == index) return;
+        }
+        Proto& proto = protos[index];
+        if(proto.sync) return;
+        if(!proto.requested)
+        {
+            proto.requested = true;
+            proto.storeChecked = false;
+        }
+        proto.priority = priority;
+
+        // 取消后已生成完成的区块直接交出
+        if(!proto.busy && proto.chunk && proto.chunk->stage == STAGE_LIT)
+        {
+            finished.emplace_back(index, std::move(proto.chunk));
+            proto.requested = false;
+            return;
+        }
+    }
+    cv.notify_one();
+}
+
+void ChunkGenerator::cancel_outside(int centerX, int centerZ, int radius)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for(auto it = protos.begin(); it != protos.end(); )
+    {
+        int dist = std::max(std::abs(it->first.first - centerX), std::abs(it->first.second - centerZ));
+        Proto& proto = it->second;
+        if(proto.sync || dist <= radius)
+        {
+            ++it;
+            continue;
+        }
+        proto.requested = false;
+        if(dist > radius + 1)
+        {
+            // 范围内区块的装饰不会再用到它的树木；执行中的阶段完成后下次再移除
+            proto.rootsWanted = false;
+            if(!proto.busy)
+            {
+                it = protos.erase(it);
+                continue;
+            }
+        }
+        ++it;
+    }
+}
+
+std::unique_ptr<Chunk> ChunkGenerator::generate_now(const ChunkIndex& index)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    for(auto it = finished.begin(); it != finished.end(); ++it)
+    {
+        if(it->first == index)
+        {
+            std::unique_ptr<Chunk> chunk = std::move(it->second);
+            finished.erase(it);
+            return chunk;
+        }
+    }
+
+    // 最高优先级，本区块与邻居的阶段在当前线程执行，工作线程正在执行的阶段等待其完成
+    Proto& proto = protos[index];
+    proto.requested = true;
+    proto.sync = true;
+    proto.storeChecked = true;
+    proto.priority = INT_MIN;
+    while(true)
+    {
+        if(!proto.busy && proto.chunk && proto.chunk->stage == STAGE_LIT)
+        {
+            std::unique_ptr<Chunk> chunk = std::move(proto.chunk);
+            proto.sync = false;
+            proto.requested = false;
+            return chunk;
+        }
+
+        Job job;
+        if(pick_job(job, &index))
+        {
+            lock.unlock();
+            run_job(job);
+            lock.lock();
+            finish_job(job);
+            cv.notify_all();
+        }
+        else
+            cv.wait(lock);
+    }
+}
+
+void ChunkGenerator::collect(std::vector<std::pair<ChunkIndex, std::unique_ptr<Chunk>>>& out)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for(auto& done : finished)
+        out.push_back(std::move(done));
+    finished.clear();
+}
+
+bool ChunkGenerator::is_idle()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if(!finished.empty()) return false;
+    for(auto& p : protos)
+    {
+        const Proto& proto = p.second;
+        if(proto.busy || proto.requested || (proto.rootsWanted && !proto.rootsReady))
+            return false;
+    }
+    return true;
+}
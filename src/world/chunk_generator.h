@@ -0,0 +1,125 @@
+#ifndef CHUNK_GENERATOR_H
+#define CHUNK_GENERATOR_H
+
+#include "chunk.h"
+#include "perlin_noise.h"
+#include "region_file.h"
+#include "delta_store.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 后台区块生成线程池（分阶段流水线）
+//
+// 生成一个区块约需百万次噪声采样，放在渲染线程上同步执行会造成明显的帧卡顿。ChunkGenerator 把它交给工作线程：
+//   request()        主线程提交区块坐标与优先级（数值越小越先生成，通常取到摄像机的距离平方）
+//   cancel_outside() 取消已离开加载范围的任务（生成中的阶段照常完成，结果留待重新进入时继续）
+//   collect()        主线程取回已完成的区块，由 Terrain 并入加载窗口
+//   generate_now()   在调用线程上立即完成一个区块（共用已生成的阶段，工作线程正在处理的阶段则等待其完成）
+// 每个区块按 ChunkStage 逐阶段推进，每个阶段是一个独立任务，不同区块的不同阶段可以在各线程上并行：
+//   STAGE_TERRAIN → STAGE_CARVED  无依赖；完成后规划本区块的树木位置
+//   STAGE_DECORATED               需要八个邻居都已规划好树木（邻居按需生成到 STAGE_CARVED，只保留树木位置）
+//   STAGE_LIT                     重放编辑记录并计算内部光照，完成后交给主线程
+// 装饰阶段只写本区块（从邻居的树木位置中取出伸入本区块的部分），不同区块的装饰互不加锁；
+// 邻居的树木位置在装饰开始时复制，之后邻居可以继续推进或被淘汰。
+// 设置了存档时被请求的区块先从区域文件读取，没有记录才由噪声生成；增量存档模式下在 STAGE_LIT 前重放编辑记录。
+// 工作线程只构造 Chunk 的 CPU 数据，不接触任何 GL 资源。
+class ChunkGenerator
+{
+    public:
+        typedef std::pair<int, int> ChunkIndex;
+
+    private:
+        // 流水线中的区块
+        struct Proto
+        {
+            std::unique_ptr<Chunk> chunk;               // 生成中的区块（为空表示尚未开始或已交出）
+            std::vector<TreeRoot> treeRoots;            // 本区块的树木（rootsReady 后不再修改）
+            bool rootsReady = false;
+            bool rootsWanted = false;                   // 邻居的装饰阶段需要本区块的树木
+            bool requested = false;                     // 需要生成到 STAGE_LIT 并交给主线程
+            bool storeChecked = false;                  // 本次请求已查询过区域文件
+            bool sync = false;                          // generate_now 正在等待，完成后不放入 finished
+            bool busy = false;                          // 某个线程正在执行它的一个阶段
+            int priority = 0;
+        };
+
+        // 一个阶段任务：stage 为要完成的阶段，STAGE_NONE 表示从区域文件读取
+        struct Job
+        {
+            ChunkIndex index;
+            ChunkStage stage = STAGE_NONE;
+            std::unique_ptr<Chunk> chunk;
+            std::vector<TreeRoot> area[9];              // 装饰阶段：3×3 范围内各区块的树木（副本）
+            std::vector<TreeRoot> roots;                // 雕刻阶段：规划出的本区块树木
+            bool planRoots = false;
+        };
+
+        PerlinNoise* perlinNoise = nullptr;     // 生成期间只读
+        const WorldGenSettings* settings = nullptr;
+        RegionStore* store = nullptr;           // 可为空（不读取存档）
+        DeltaStore* deltas = nullptr;           // 可为空（不重放编辑）
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool stopping = false;
+
+        std::map<ChunkIndex, Proto> protos;
+        bool expanded = false;                  // 本次扫描登记了新的邻居依赖
+        std::vector<std::pair<ChunkIndex, std::unique_ptr<Chunk>>> finished;
+
+        void worker_loop();
+
+        // 为 index 找一个可执行的阶段（持锁调用）；依赖的邻居尚未就绪时登记为需要，返回 false
+        bool job_for(const ChunkIndex& index, Proto& proto, Job& job);
+
+        // 取优先级数值最小的可执行任务并标记为执行中（持锁调用）；near 非空时只在其 3×3 范围内找
+        bool pick_job(Job& job, const ChunkIndex* near);
+
+        // 执行任务（不持锁）
+        void run_job(Job& job);
+
+        // 写回任务结果（持锁调用）
+        void finish_job(Job& job);
+
+    public:
+        ChunkGenerator(){};
+
+        ~ChunkGenerator()
+        {
+            stop();
+        }
+
+        // threadCount <= 0 时按硬件线程数自动选择（保留一个核心给渲染线程）
+        // genSettings 在生成期间只读，须在 stop() 之前保持有效
+        void start(PerlinNoise* noise, const WorldGenSettings* genSettings, RegionStore* regionStore = nullptr,
+                   DeltaStore* deltaStore = nullptr, int threadCount = 0);
+
+        // 停止并等待所有工作线程退出，丢弃未完成的任务
+        void stop();
+
+        // 提交生成任务；已在生成的任务只刷新优先级
+        void request(const ChunkIndex& index, int priority);
+
+        // 取消与 (centerX, centerZ) 的切比雪夫距离超过 radius 的任务
+        // 再外一圈的区块保留树木位置（范围内区块的装饰阶段需要），更远的从流水线中移除
+        void cancel_outside(int centerX, int centerZ, int radius);
+
+        // 在当前线程上由噪声生成区块（不读取区域文件，调用方已确认没有记录；增量存档照常重放）
+        std::unique_ptr<Chunk> generate_now(const ChunkIndex& index);
+
+        // 取回所有已完成的区块（追加到 out）
+        void collect(std::vector<std::pair<ChunkIndex, std::unique_ptr<Chunk>>>& out);
+
+        // 没有待推进的阶段、执行中或待取回的任务
+        bool is_idle();
+
+        ChunkGenerator(const ChunkGenerator&) = delete;
+        ChunkGenerator& operator=(const ChunkGenerator&) = delete;
+};
+
+#endif
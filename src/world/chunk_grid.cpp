@@ -0,0 +1,60 @@
+#include "chunk_grid.h"
+
+void ChunkGrid::reset(int newRadius, int cx, int cz, ChunkList& evicted)
+{
+    // 先取出全部区块，换成新边长后把仍在窗口内的放回
+    ChunkList all;
+    clear(all);
+
+    radius = newRadius;
+    side = 2 * newRadius + 1;
+    centerX = cx;
+    centerZ = cz;
+    keys.assign((size_t)side * side, ChunkIndex(0, 0));
+    slots.clear();
+    slots.resize((size_t)side * side);
+
+    for(auto& entry : all)
+    {
+        if(contains(entry.first))
+            put(entry.first, std::move(entry.second));
+        else
+            evicted.push_back(std::move(entry));
+    }
+}
+
+void ChunkGrid::recenter(int cx, int cz, ChunkList& evicted)
+{
+    if(cx == centerX && cz == centerZ) return;
+    centerX = cx;
+    centerZ = cz;
+
+    // 槽位与窗口位置无关，只需移出坐标已不在新窗口内的区块
+    for(size_t s = 0; s < slots.size(); s++)
+    {
+        if(slots[s] && !contains(keys[s]))
+        {
+            evicted.emplace_back(keys[s], std::move(slots[s]));
+            loaded--;
+        }
+    }
+}
+
+Chunk* ChunkGrid::put(const ChunkIndex& index, std::unique_ptr<Chunk> chunk)
+{
+    int slot = slot_of(index.first, index.second);
+    if(!slots[slot]) loaded++;
+    keys[slot] = index;
+    slots[slot] = std::move(chunk);
+    return slots[slot].get();
+}
+
+void ChunkGrid::clear(ChunkList& evicted)
+{
+    for(size_t s = 0; s < slots.size(); s++)
+    {
+        if(slots[s])
+            evicted.emplace_back(keys[s], std::move(slots[s]));
+    }
+    loaded = 0;
+}
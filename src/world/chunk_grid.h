@@ -0,0 +1,82 @@
+#ifndef CHUNK_GRID_H
+#define CHUNK_GRID_H
+
+#include "chunk.h"
+#include <memory>
+#include <utility>
+#include <vector>
+
+// 以玩家所在区块为中心的环形（toroidal）区块网格
+//
+// 加载窗口为 (2 * radius + 1)² 个区块，槽位按区块坐标对边长取模定位：
+// 窗口内任意两个区块落在不同槽位，查找只需一次取模与坐标比较，不做任何分配。
+// 玩家移动时窗口整体平移，只有离开窗口的区块被移出（交还调用方处理），其余槽位原地不动。
+class ChunkGrid
+{
+    public:
+        typedef std::pair<int, int> ChunkIndex;
+        typedef std::vector<std::pair<ChunkIndex, std::unique_ptr<Chunk>>> ChunkList;
+
+    private:
+        int radius = 0;
+        int side = 1;                                   // 窗口边长 2 * radius + 1
+        int centerX = 0, centerZ = 0;
+        size_t loaded = 0;                              // 已占用的槽位数
+        std::vector<ChunkIndex> keys;                   // 槽位当前存放的区块坐标
+        std::vector<std::unique_ptr<Chunk>> slots;
+
+        int slot_of(int x, int z) const
+        {
+            int sx = x % side, sz = z % side;
+            if(sx < 0) sx += side;
+            if(sz < 0) sz += side;
+            return sz * side + sx;
+        }
+
+    public:
+        ChunkGrid() : keys(1), slots(1) {};
+
+        // 重新设置窗口半径与中心，窗口外的区块移出到 evicted
+        void reset(int newRadius, int cx, int cz, ChunkList& evicted);
+
+        // 平移窗口中心，离开窗口的区块移出到 evicted
+        void recenter(int cx, int cz, ChunkList& evicted);
+
+        bool contains(const ChunkIndex& index) const
+        {
+            return index.first >= centerX - radius && index.first <= centerX + radius
+                && index.second >= centerZ - radius && index.second <= centerZ + radius;
+        }
+
+        Chunk* find(const ChunkIndex& index) const
+        {
+            if(!contains(index)) return nullptr;
+            int slot = slot_of(index.first, index.second);
+            return (slots[slot] && keys[slot] == index) ? slots[slot].get() : nullptr;
+        }
+
+        // 放入窗口内的区块（调用方保证 contains(index)），返回放入后的指针
+        Chunk* put(const ChunkIndex& index, std::unique_ptr<Chunk> chunk);
+
+        // 移出全部区块
+        void clear(ChunkList& evicted);
+
+        int get_radius() const { return radius; }
+        int center_x() const { return centerX; }
+        int center_z() const { return centerZ; }
+        size_t size() const { return loaded; }
+
+        // 遍历所有已加载区块：f(const ChunkIndex&, Chunk&)
+        template<class F> void for_each(F f) const
+        {
+            for(size_t s = 0; s < slots.size(); s++)
+            {
+                if(slots[s]) f(keys[s], *slots[s]);
+            }
+        }
+
+        ChunkGrid(const ChunkGrid&) = delete;
+        ChunkGrid& operator=(const ChunkGrid&) = delete;
+};
+
+#endif
@@ -0,0 +1,451 @@
+#include "chunk_mesher.h"
+#include <algorithm>
+
+using namespace std;
+
+// 地形顶点的纹理坐标：图集格子编号 tile + 格内重复坐标 (u, v)（打包格式见 TerrainVertex）
+// u 沿 v1→v2 方向、v 沿 v1→v3 方向，单个面为 [0,1]，合并后的面为 [0,w]×[0,h]；
+// 片段着色器对 (u, v) 取 fract 后在同一格子内重复采样（见 blockShader）
+// 各面的格子编号取自编译期方块属性表 BLOCK_TABLE
+
+// 面方向（0~5）对应的纹理面：Down 用底面、Up 用顶面，其余为侧面
+static inline int face_tile(BLOCK_TYPE blockType, int face)
+{
+    return get_block_tile(blockType, face == 5 ? BLOCK_FACE_TOP : face == 4 ? BLOCK_FACE_BOTTOM : BLOCK_FACE_SIDE);
+}
+
+// 贪婪合并时各面方向的坐标轴（mesh 空间，0=x 1=y 2=z）：n 为法线轴，u/v 为面内轴
+// u/v 的正方向与 faceVertexOffset 中 v1→v2、v1→v3 一致，合并后纹理朝向与单个面相同
+struct FaceAxes { int n, u, v, uSign, vSign; };
+static const FaceAxes greedyAxes[6] = {
+    {2, 0, 1,  1, -1},   // [0] Back:    +Z
+    {2, 0, 1,  1, -1},   // [1] Forward: -Z
+    {0, 2, 1, -1, -1},   // [2] Left:    -X
+    {0, 2, 1, -1, -1},   // [3] Right:   +X
+    {1, 2, 0, -1,  1},   // [4] Down:    -Y
+    {1, 2, 0, -1,  1},   // [5] Up:      +Y
+};
+
+void ChunkMesher::start(int threadCount)
+{
+    stop();
+    if(threadCount <= 0)
+    {
+        int hw = (int)std::thread::hardware_concurrency();
+        threadCount = std::max(1, std::min(hw - 1, 2));
+    }
+    for(int t = 0; t < threadCount; t++)
+        workers.emplace_back(&ChunkMesher::worker_loop, this);
+}
+
+void ChunkMesher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    for(std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    stopping = false;
+    pending.clear();
+    finished.clear();
+}
+
+void ChunkMesher::worker_loop()
+{
+    while(true)
+    {
+        std::unique_ptr<ChunkMeshInput> input;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this]{ return stopping || !pending.empty(); });
+            if(stopping) return;
+
+            auto best = pending.begin();
+            for(auto it = pending.begin(); it != pending.end(); ++it)
+            {
+                if(it->second.first < best->second.first)
+                    best = it;
+            }
+            input = std::move(best->second.second);
+            pending.erase(best);
+            running++;
+        }
+
+        ChunkMeshResult result;
+        build(*input, result);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        running--;
+        if(!stopping)
+            finished.push_back(std::move(result));
+    }
+}
+
+void ChunkMesher::submit(std::unique_ptr<ChunkMeshInput> input, int priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::pair<int, int> index = input->index;
+        pending[index] = std::make_pair(priority, std::move(input));
+    }
+    cv.notify_one();
+}
+
+void ChunkMesher::collect(std::vector<ChunkMeshResult>& out)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for(ChunkMeshResult& result : finished)
+        out.push_back(std::move(result));
+    finished.clear();
+}
+
+bool ChunkMesher::is_idle()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return pending.empty() && running == 0 && finished.empty();
+}
+
+void ChunkMesher::build(const ChunkMeshInput& in, ChunkMeshResult& out)
+{
+    out.index = in.index;
+    out.sections.clear();
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        if(in.levels[s] >= MESH_FULL_REBUILD)
+        {
+            out.sections.emplace_back();
+            build_section_mesh(in, s, out.sections.back());
+        }
+        else if(in.levels[s] >= MESH_BORDER_REFRESH && !in.snapshot.is_empty(s))
+        {
+            out.sections.emplace_back();
+            build_section_border(in, s, out.sections.back());
+        }
+    }
+}
+
+BLOCK_TYPE ChunkMesher::block_at(const ChunkMeshInput& in, int i, int j, int k)
+{
+    return in.snapshot.block_at(i, j, k);
+}
+
+BLOCK_TYPE ChunkMesher::get_neighbor_block(const ChunkMeshInput& in, int i, int j, int k, int face)
+{
+    // 法线 (mesh空间) → 数组偏移: di = -nz (数组i是反向Z), dj = nx, dk = ny
+    int ni = i - (int)Chunk::faceNormal[face].z;
+    int nj = j + (int)Chunk::faceNormal[face].x;
+    int nk = k + (int)Chunk::faceNormal[face].y;
+
+    if(nk >= CHUNK_HEIGHT || nk < 0)
+        return AIR;
+    if(ni >= 0 && ni < CHUNK_SIZE && nj >= 0 && nj < CHUNK_SIZE)
+        return block_at(in, ni, nj, nk);
+    if(nj == CHUNK_SIZE && in.hasNeighbour[1])
+        return in.borderBlocks[1][i * CHUNK_HEIGHT + k];
+    if(nj < 0 && in.hasNeighbour[0])
+        return in.borderBlocks[0][i * CHUNK_HEIGHT + k];
+    if(ni == CHUNK_SIZE && in.hasNeighbour[2])
+        return in.borderBlocks[2][j * CHUNK_HEIGHT + k];
+    if(ni < 0 && in.hasNeighbour[3])
+        return in.borderBlocks[3][j * CHUNK_HEIGHT + k];
+    return AIR;
+}
+
+uint8_t ChunkMesher::get_neighbor_light(const ChunkMeshInput& in, int i, int j, int k, int face)
+{
+    int ni = i - (int)Chunk::faceNormal[face].z;
+    int nj = j + (int)Chunk::faceNormal[face].x;
+    int nk = k + (int)Chunk::faceNormal[face].y;
+
+    if(nk >= CHUNK_HEIGHT) return 0xF0;    // 世界顶部：天空满亮度，方块光 0
+    if(nk < 0) return 0;
+
+    if(ni >= 0 && ni < CHUNK_SIZE && nj >= 0 && nj < CHUNK_SIZE)
+        return in.snapshot.light_at(ni, nj, nk);
+    if(nj == CHUNK_SIZE && in.hasNeighbour[1])
+        return in.borderLights[1][i * CHUNK_HEIGHT + nk];
+    if(nj < 0 && in.hasNeighbour[0])
+        return in.borderLights[0][i * CHUNK_HEIGHT + nk];
+    if(ni == CHUNK_SIZE && in.hasNeighbour[2])
+        return in.borderLights[2][j * CHUNK_HEIGHT + nk];
+    if(ni < 0 && in.hasNeighbour[3])
+        return in.borderLights[3][j * CHUNK_HEIGHT + nk];
+    return 0xF0;   // 邻居区块未加载，默认满亮度
+}
+
+void ChunkMesher::build_greedy_faces(const ChunkMeshInput& in, int s, int face, SectionMesh* interior, SectionMesh* border)
+{
+    const FaceAxes& ax = greedyAxes[face];
+    int kBegin = s * SECTION_HEIGHT;
+
+    auto axis_len = [](int axis) { return axis == 1 ? SECTION_HEIGHT : CHUNK_SIZE; };
+    auto axis_coord = [&](int axis, int sign, int t) {
+        int base = (axis == 1) ? kBegin : 0;
+        return base + (sign > 0 ? t : axis_len(axis) - 1 - t);
+    };
+
+    // 朝向区块外的切片为边界面（上下面不会跨区块）
+    int borderSlice = -1;
+    if(face == 0) borderSlice = CHUNK_SIZE - 1;     // i = 0
+    else if(face == 1) borderSlice = 0;             // i = CHUNK_SIZE-1
+    else if(face == 2) borderSlice = 0;             // j = 0
+    else if(face == 3) borderSlice = CHUNK_SIZE - 1;// j = CHUNK_SIZE-1
+
+    int uLen = axis_len(ax.u), vLen = axis_len(ax.v);
+    int sliceBegin = (ax.n == 1) ? kBegin : 0;
+    int sliceEnd = (ax.n == 1) ? kBegin + SECTION_HEIGHT : CHUNK_SIZE;
+
+    glm::vec3 uDir(0.0f), vDir(0.0f);
+    uDir[ax.u] = (float)ax.uSign;
+    vDir[ax.v] = (float)ax.vSign;
+
+    // 掩码：0 表示该位置无需生成面，否则为 1 + (方块类型 << 8 | 光照字节)
+    int mask[CHUNK_SIZE * CHUNK_SIZE];
+
+    for(int slice = sliceBegin; slice < sliceEnd; slice++)
+    {
+        SectionMesh* target = (slice == borderSlice) ? border : interior;
+        if(!target) continue;
+
+        for(int b = 0; b < vLen; b++)
+        {
+            for(int a = 0; a < uLen; a++)
+            {
+                glm::ivec3 p;
+                p[ax.n] = slice;
+                p[ax.u] = axis_coord(ax.u, ax.uSign, a);
+                p[ax.v] = axis_coord(ax.v, ax.vSign, b);
+                int i = CHUNK_SIZE - 1 - p.z, j = p.x, k = p.y;
+
+                int key = 0;
+                BLOCK_TYPE blockType = block_at(in, i, j, k);
+                if(blockType != AIR && blockType != TORCH && !is_translucent(blockType))
+                {
+                    BLOCK_TYPE neighborBlock = get_neighbor_block(in, i, j, k, face);
+                    if(is_transparent(neighborBlock) && neighborBlock != blockType)
+                        key = 1 + ((int)blockType << 8 | get_neighbor_light(in, i, j, k, face));
+                }
+                mask[b * uLen + a] = key;
+            }
+        }
+
+        // 贪婪合并：先沿 u 尽量延伸，再整行沿 v 延伸
+        for(int b = 0; b < vLen; b++)
+        {
+            for(int a = 0; a < uLen; )
+            {
+                int key = mask[b * uLen + a];
+                if(key == 0) { a++; continue; }
+
+                int w = 1;
+                while(a + w < uLen && mask[b * uLen + a + w] == key) w++;
+                int h = 1;
+                for(; b + h < vLen; h++)
+                {
+                    bool rowMatch = true;
+                    for(int t = 0; t < w; t++)
+                    {
+                        if(mask[(b + h) * uLen + a + t] != key) { rowMatch = false; break; }
+                    }
+                    if(!rowMatch) break;
+                }
+                for(int dv = 0; dv < h; dv++)
+                    for(int du = 0; du < w; du++)
+                        mask[(b + dv) * uLen + a + du] = 0;
+
+                BLOCK_TYPE blockType = (BLOCK_TYPE)((key - 1) >> 8);
+                uint8_t light = (uint8_t)((key - 1) & 0xFF);
+                int tile = face_tile(blockType, face);
+
+                glm::ivec3 p;
+                p[ax.n] = slice;
+                p[ax.u] = axis_coord(ax.u, ax.uSign, a);
+                p[ax.v] = axis_coord(ax.v, ax.vSign, b);
+                glm::vec3 origin = glm::vec3(p) + Chunk::faceVertexOffset[face][0];
+                glm::vec3 du = uDir * (float)w, dv = vDir * (float)h;
+
+                target->create_face(
+                    TerrainVertex(origin,           face, tile, 0, 0, light),
+                    TerrainVertex(origin + du,      face, tile, w, 0, light),
+                    TerrainVertex(origin + dv,      face, tile, 0, h, light),
+                    TerrainVertex(origin + du + dv, face, tile, w, h, light));
+
+                a += w;
+            }
+        }
+    }
+}
+
+void ChunkMesher::build_section_mesh(const ChunkMeshInput& in, int s, SectionMesh& mesh)
+{
+    mesh.section = s;
+    mesh.borderOnly = false;
+
+    // 全空气分段：没有任何面片，应用时释放
+    if(in.snapshot.is_empty(s))
+        return;
+
+    // 边界面临时 buffer（遍历结束后追加到主 buffer）
+    SectionMesh border;
+
+    // 单趟遍历：内部面直接写入主 buffer，边界面写入临时 buffer
+    for(int i = CHUNK_SIZE-1; i >= 0; i--)
+    {
+        for(int j = 0; j < CHUNK_SIZE; j++)
+        {
+            for(int k = s * SECTION_HEIGHT; k < (s + 1) * SECTION_HEIGHT; k++)
+            {
+                BLOCK_TYPE blockType = block_at(in, i, j, k);
+                if(blockType == AIR) continue;
+
+                glm::vec3 blockPos(j, k, CHUNK_SIZE-1-i);
+
+                // ===== 火把：十字交叉面片（2 对角 quad × 正反面 = 4 quad） =====
+                if(blockType == TORCH)
+                {
+                    int tile = get_block_tile(TORCH, BLOCK_FACE_SIDE);
+                    uint8_t light = in.snapshot.light_at(i, j, k);
+
+                    // 面方向记为 5 / 3，使 v1 - faceVertexOffset[face][0] 恰好还原方块坐标（见 refresh_vertex_lights）
+                    TerrainVertex a0(blockPos + glm::vec3(0,1,1), 5, tile, 0, 0, light);
+                    TerrainVertex a1(blockPos + glm::vec3(1,1,0), 5, tile, 1, 0, light);
+                    TerrainVertex a2(blockPos + glm::vec3(0,0,1), 5, tile, 0, 1, light);
+                    TerrainVertex a3(blockPos + glm::vec3(1,0,0), 5, tile, 1, 1, light);
+                    mesh.create_face(a0, a1, a2, a3);
+                    mesh.create_face(a0, a2, a1, a3);
+
+                    TerrainVertex b0(blockPos + glm::vec3(1,1,1), 3, tile, 0, 0, light);
+                    TerrainVertex b1(blockPos + glm::vec3(0,1,0), 3, tile, 1, 0, light);
+                    TerrainVertex b2(blockPos + glm::vec3(1,0,1), 3, tile, 0, 1, light);
+                    TerrainVertex b3(blockPos + glm::vec3(0,0,0), 3, tile, 1, 1, light);
+                    mesh.create_face(b0, b1, b2, b3);
+                    mesh.create_face(b0, b2, b1, b3);
+
+                    continue;
+                }
+
+                // ===== 贪婪模式下不透明方块的面在下方按切片合并生成 =====
+                if(in.greedy && !is_translucent(blockType)) continue;
+
+                // ===== 常规方块：6 面检查 =====
+                for(int face = 0; face < 6; ++face)
+                {
+                    BLOCK_TYPE neighborBlock = get_neighbor_block(in, i, j, k, face);
+                    if(!is_transparent(neighborBlock)) continue;
+                    if(neighborBlock == blockType) continue;
+
+                    int tile = face_tile(blockType, face);
+                    uint8_t light = get_neighbor_light(in, i, j, k, face);
+
+                    const glm::vec3* offset = Chunk::faceVertexOffset[face];
+                    TerrainVertex v1(blockPos + offset[0], face, tile, 0, 0, light);
+                    TerrainVertex v2(blockPos + offset[1], face, tile, 1, 0, light);
+                    TerrainVertex v3(blockPos + offset[2], face, tile, 0, 1, light);
+                    TerrainVertex v4(blockPos + offset[3], face, tile, 1, 1, light);
+
+                    // 边界面 → 临时 buffer，内部面 → 主 buffer
+                    SectionMesh& target = Chunk::is_border_face(i, j, face) ? border : mesh;
+                    if(is_translucent(blockType))
+                        target.create_face_transparent(v1, v2, v3, v4);
+                    else
+                        target.create_face(v1, v2, v3, v4);
+                }
+            }
+        }
+    }
+
+    // 贪婪模式：不透明面按切片合并，朝向区块外的切片写入边界 buffer
+    if(in.greedy)
+    {
+        for(int face = 0; face < 6; face++)
+            build_greedy_faces(in, s, face, &mesh, &border);
+    }
+
+    // 记录内部/边界分割点
+    mesh.borderVertexStart = mesh.vertices.size();
+    mesh.borderVertexTStart = mesh.verticesT.size();
+    mesh.borderIndexTStart = mesh.indicesT.size();
+    mesh.borderFaceCenterStart = mesh.transparentFaceCenters.size();
+
+    // 追加边界面数据（索引需要 rebase）
+    if(!border.vertices.empty())
+    {
+        mesh.vertices.insert(mesh.vertices.end(), border.vertices.begin(), border.vertices.end());
+    }
+    if(!border.verticesT.empty())
+    {
+        unsigned int offset = (unsigned int)mesh.verticesT.size();
+        mesh.verticesT.insert(mesh.verticesT.end(), border.verticesT.begin(), border.verticesT.end());
+        for(unsigned int idx : border.indicesT)
+            mesh.indicesT.push_back(idx + offset);
+        mesh.transparentFaceCenters.insert(mesh.transparentFaceCenters.end(),
+            border.transparentFaceCenters.begin(), border.transparentFaceCenters.end());
+    }
+}
+
+void ChunkMesher::build_section_border(const ChunkMeshInput& in, int s, SectionMesh& mesh)
+{
+    mesh.section = s;
+    mesh.borderOnly = true;
+
+    // 生成单个边界面的 lambda
+    auto gen_border_face = [&](int i, int j, int k, int face)
+    {
+        BLOCK_TYPE blockType = block_at(in, i, j, k);
+        if(blockType == AIR || blockType == TORCH) return;
+        if(in.greedy && !is_translucent(blockType)) return;   // 由贪婪合并生成
+
+        BLOCK_TYPE neighborBlock = get_neighbor_block(in, i, j, k, face);
+        if(!is_transparent(neighborBlock)) return;
+        if(neighborBlock == blockType) return;
+
+        glm::vec3 blockPos(j, k, CHUNK_SIZE-1-i);
+        int tile = face_tile(blockType, face);
+        uint8_t light = get_neighbor_light(in, i, j, k, face);
+
+        const glm::vec3* offset = Chunk::faceVertexOffset[face];
+        TerrainVertex v1(blockPos + offset[0], face, tile, 0, 0, light);
+        TerrainVertex v2(blockPos + offset[1], face, tile, 1, 0, light);
+        TerrainVertex v3(blockPos + offset[2], face, tile, 0, 1, light);
+        TerrainVertex v4(blockPos + offset[3], face, tile, 1, 1, light);
+        if(is_translucent(blockType))
+            mesh.create_face_transparent(v1, v2, v3, v4);
+        else
+            mesh.create_face(v1, v2, v3, v4);
+    };
+
+    // 只遍历分段内的 4 条边界面，每条检查确定的 1 个面方向
+    int kBegin = s * SECTION_HEIGHT, kEnd = (s + 1) * SECTION_HEIGHT;
+
+    // i=0 → face 0 (Back, +Z)
+    for(int j = 0; j < CHUNK_SIZE; j++)
+        for(int k = kBegin; k < kEnd; k++)
+            gen_border_face(0, j, k, 0);
+
+    // i=CHUNK_SIZE-1 → face 1 (Forward, -Z)
+    for(int j = 0; j < CHUNK_SIZE; j++)
+        for(int k = kBegin; k < kEnd; k++)
+            gen_border_face(CHUNK_SIZE-1, j, k, 1);
+
+    // j=0 → face 2 (Left, -X)
+    for(int i = 0; i < CHUNK_SIZE; i++)
+        for(int k = kBegin; k < kEnd; k++)
+            gen_border_face(i, 0, k, 2);
+
+    // j=CHUNK_SIZE-1 → face 3 (Right, +X)
+    for(int i = 0; i < CHUNK_SIZE; i++)
+        for(int k = kBegin; k < kEnd; k++)
+            gen_border_face(i, CHUNK_SIZE-1, k, 3);
+
+    // 贪婪模式：只重建四个侧面方向朝外的那一层切片
+    if(in.greedy)
+    {
+        for(int face = 0; face < 4; face++)
+            build_greedy_faces(in, s, face, nullptr, &mesh);
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef CHUNK_MESHER_H
+#define CHUNK_MESHER_H
+
+#include "chunk.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// mesh 构建输入：本区块的写时复制快照 + 从四个邻居拷贝出的边界
+// 工作线程只读取快照，构建期间主线程可以继续修改区块本身
+struct ChunkMeshInput
+{
+    std::pair<int, int> index;                      // 区块索引
+    MeshUpdateLevel levels[SECTION_NUM];            // 各分段需要的更新等级
+    ChunkSnapshot snapshot;                         // 全部分段的方块与光照（上下面需要相邻分段）
+    bool greedy = true;                             // 不透明面是否贪婪合并
+
+    // 四个邻居朝向本区块的一层边界，顺序同 neighbours[4]: {left(-X), right(+X), forward(-Z), back(+Z)}
+    // 下标 p * CHUNK_HEIGHT + k，p 为沿边界方向的数组坐标（左右邻居为 i，前后邻居为 j）
+    bool hasNeighbour[4] = {};
+    std::vector<BLOCK_TYPE> borderBlocks[4];
+    std::vector<uint8_t> borderLights[4];
+};
+
+// 一个区块的 mesh 构建结果（只包含需要更新的分段）
+struct ChunkMeshResult
+{
+    std::pair<int, int> index;
+    std::vector<SectionMesh> sections;
+
+    size_t byte_size() const
+    {
+        size_t bytes = 0;
+        for(const SectionMesh& mesh : sections) bytes += mesh.byte_size();
+        return bytes;
+    }
+};
+
+// 区块 mesh 构建线程池
+//
+// 面片生成与 GL 上传分为两个阶段：
+//   1. submit()  主线程提交快照，工作线程调用 build() 生成顶点/索引
+//   2. collect() 主线程取回结果，在每帧预算内经 Chunk::apply_mesh 并入区块，再由 Terrain 上传
+// build() 只依赖快照，也可以在任意线程同步调用。
+class ChunkMesher
+{
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool stopping = false;
+        int running = 0;                                            // 正在构建的任务数
+
+        std::map<std::pair<int, int>, std::pair<int, std::unique_ptr<ChunkMeshInput>>> pending;   // 区块 → (优先级, 快照)
+        std::vector<ChunkMeshResult> finished;
+
+        void worker_loop();
+
+        // 快照内的方块/光照查询（与 Chunk 中的同名函数语义一致，邻居取自边界快照）
+        static BLOCK_TYPE block_at(const ChunkMeshInput& in, int i, int j, int k);
+        static BLOCK_TYPE get_neighbor_block(const ChunkMeshInput& in, int i, int j, int k, int face);
+        static uint8_t get_neighbor_light(const ChunkMeshInput& in, int i, int j, int k, int face);   // 光照字节
+
+        // 贪婪合并一个面方向的不透明面：按法线方向逐层切片，同类型同光照的相邻面合并为一个矩形
+        // 朝向区块外的切片写入 border，其余写入 interior（为 nullptr 时跳过对应切片）
+        static void build_greedy_faces(const ChunkMeshInput& in, int s, int face, SectionMesh* interior, SectionMesh* border);
+
+        // 构建单个分段的完整 mesh / 仅构建其边界面片
+        static void build_section_mesh(const ChunkMeshInput& in, int s, SectionMesh& mesh);
+        static void build_section_border(const ChunkMeshInput& in, int s, SectionMesh& mesh);
+
+    public:
+        ChunkMesher(){};
+
+        ~ChunkMesher()
+        {
+            stop();
+        }
+
+        // threadCount <= 0 时按硬件线程数自动选择
+        void start(int threadCount = 0);
+
+        // 停止并等待所有工作线程退出，丢弃未完成的任务
+        void stop();
+
+        // 提交构建任务（优先级数值越小越先构建）
+        void submit(std::unique_ptr<ChunkMeshInput> input, int priority);
+
+        // 取回所有已完成的结果（追加到 out）
+        void collect(std::vector<ChunkMeshResult>& out);
+
+        bool is_idle();
+
+        // 按快照中各分段的更新等级构建 mesh
+        static void build(const ChunkMeshInput& in, ChunkMeshResult& out);
+
+        ChunkMesher(const ChunkMesher&) = delete;
+        ChunkMesher& operator=(const ChunkMesher&) = delete;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include <glad/glad.h>
+#include "chunk_render_data.h"
+
+#include <vector>
+
+using namespace std;
+
+void SectionRenderData::upload_opaque(const ChunkSection& section, VertexArena& arena)
+{
+    // 旧区间可能仍被上一帧的绘制读取，不能原地覆盖
+    arena.release(opaqueRange);
+    opaqueRange = arena.allocate(section.vertices);   // 没有不透明面片时为空区间
+}
+
+void SectionRenderData::upload_transparent(const ChunkSection& section, VertexArena& arena)
+{
+    arena.release(transparentRange);
+    if(section.verticesT.empty())   // 该分段没有透明面片
+    {
+        if (transparentEBO != 0) glDeleteBuffers(1, &transparentEBO);
+        transparentEBO = 0;
+        return;
+    }
+    transparentRange = arena.allocate(section.verticesT);
+
+    // 先解绑 VAO，避免改写共享 VAO 记录的索引缓冲
+    glBindVertexArray(0);
+    if (transparentEBO == 0) glGenBuffers(1, &transparentEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, transparentEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, section.indicesT.size() * sizeof(unsigned int), section.indicesT.data(), GL_DYNAMIC_DRAW);
+}
+
+void SectionRenderData::upload_transparent_indices(const ChunkSection& section)
+{
+    // 仅重传透明EBO（顶点不动）
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, transparentEBO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, section.indicesT.size() * sizeof(unsigned int), section.indicesT.data());
+}
+
+void SectionRenderData::release(VertexArena& arena)
+{
+    arena.release(opaqueRange);
+    arena.release(transparentRange);
+    // 释放前检查ID是否有效（0是安全的，glDelete会忽略）
+    if (transparentEBO != 0) glDeleteBuffers(1, &transparentEBO);
+    transparentEBO = 0;
+}
+
+void ChunkRenderData::upload(const Chunk& chunk, unsigned int sectionMask, VertexArena& arena)
+{
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        if(sectionMask & (1u << s))
+        {
+            sections[s].upload_opaque(chunk.sections[s], arena);
+            sections[s].upload_transparent(chunk.sections[s], arena);
+        }
+    }
+}
+
+unsigned int ChunkRenderData::vertex_count() const
+{
+    unsigned int count = 0;
+    for(const SectionRenderData& section : sections)
+        count += section.opaqueRange.count + section.transparentRange.count;
+    return count;
+}
+
+void ChunkRenderData::release(VertexArena& arena)
+{
+    for(SectionRenderData& section : sections)
+        section.release(arena);
+}
+
+static unsigned int quadEBO = 0;
+
+unsigned int ChunkRenderData::quad_index_buffer()
+{
+    if(quadEBO != 0) return quadEBO;
+
+    vector<unsigned int> quadIndices((size_t)SECTION_MAX_QUADS * 6);
+    for(unsigned int q = 0; q < SECTION_MAX_QUADS; q++)
+    {
+        unsigned int base = q * 4;
+        quadIndices[q*6+0] = base + 2;
+        quadIndices[q*6+1] = base + 1;
+        quadIndices[q*6+2] = base + 0;
+        quadIndices[q*6+3] = base + 1;
+        quadIndices[q*6+4] = base + 2;
+        quadIndices[q*6+5] = base + 3;
+    }
+    // 先解绑 VAO，避免覆盖当前 VAO 记录的索引缓冲
+    glBindVertexArray(0);
+    glGenBuffers(1, &quadEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, quadIndices.size() * sizeof(unsigned int), quadIndices.data(), GL_STATIC_DRAW);
+    return quadEBO;
+}
+
+void ChunkRenderData::release_quad_index_buffer()
+{
+    if(quadEBO != 0) glDeleteBuffers(1, &quadEBO);
+    quadEBO = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef CHUNK_RENDER_DATA_H
+#define CHUNK_RENDER_DATA_H
+
+#include "chunk.h"
+#include "chunk_section.h"
+#include "../render/vertex_arena.h"
+
+// 单个分段的 GPU 资源（顶点在显存池中的区间 + 透明索引缓冲），只在 GL 线程使用
+struct SectionRenderData
+{
+    VertexArena::Range opaqueRange;                 // 不透明顶点在显存池中的区间（索引为共享的 quad_index_buffer()）
+    VertexArena::Range transparentRange;            // 透明顶点在显存池中的区间
+    unsigned int transparentEBO = 0;                // 透明索引缓冲（每帧按距离重排后重传）
+
+    bool empty() const { return opaqueRange.empty() && transparentRange.empty(); }
+
+    // 分段的 CPU mesh 写入显存池新分配的区间，旧区间延迟到 GPU 用完后回收（几何或顶点光照变化后调用）
+    void upload_opaque(const ChunkSection& section, VertexArena& arena);
+    void upload_transparent(const ChunkSection& section, VertexArena& arena);
+
+    // 只重传透明索引（ChunkSection::sort_transparent_faces 重排之后）
+    void upload_transparent_indices(const ChunkSection& section);
+
+    // 归还显存池区间并删除透明索引缓冲
+    void release(VertexArena& arena);
+};
+
+// 区块的渲染资源
+//
+// Chunk 只保存方块、光照与 CPU mesh，可以在任意线程（或没有 GL 上下文的进程中）创建、移动和销毁；
+// 显存区间与 GL 缓冲集中在这里，由 Terrain 按区块索引持有，只在 GL 线程创建、上传和释放。
+// 区块的 CPU mesh 变化后（Chunk::apply_mesh / refresh_vertex_lights 返回分段掩码）由 upload() 写入显存池，
+// 区块被淘汰时由 Terrain 调用 release() 归还（区间随后照常经 fence 回收）。
+class ChunkRenderData
+{
+    public:
+        SectionRenderData sections[SECTION_NUM];
+
+        ChunkRenderData(){};
+
+        // 把 sectionMask 中各分段（第 s 位对应分段 s）的 CPU mesh 写入显存池（必须在 GL 线程调用）
+        void upload(const Chunk& chunk, unsigned int sectionMask, VertexArena& arena);
+
+        // 持有的顶点数（不透明 + 透明）
+        unsigned int vertex_count() const;
+
+        // 归还全部分段的资源（必须在 GL 线程调用）
+        void release(VertexArena& arena);
+
+        // 所有分段共用的四边形索引缓冲：第 q 个面为 4q+2, 4q+1, 4q, 4q+1, 4q+2, 4q+3
+        // 首次调用时按 SECTION_MAX_QUADS 一次性构建（必须在 GL 线程调用）
+        static unsigned int quad_index_buffer();
+        static void release_quad_index_buffer();
+
+        ChunkRenderData(const ChunkRenderData&) = delete;
+        ChunkRenderData& operator=(const ChunkRenderData&) = delete;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include "chunk_scheduler.h"
+#include <algorithm>
+
+using namespace std;
+
+bool ChunkScheduler::take_ready(vector<ChunkIndex>& out)
+{
+    out.assign(ready.begin(), ready.end());
+    ready.clear();
+    return !out.empty();
+}
+
+void ChunkScheduler::wait_for(const ChunkIndex& dependency, const ChunkIndex& index)
+{
+    vector<ChunkIndex>& list = waiters[dependency];
+    if(find(list.begin(), list.end(), index) == list.end())
+        list.push_back(index);
+}
+
+void ChunkScheduler::wake(const ChunkIndex& dependency)
+{
+    auto it = waiters.find(dependency);
+    if(it == waiters.end()) return;
+    for(const ChunkIndex& index : it->second)
+        ready.insert(index);
+    waiters.erase(it);
+}
+
+void ChunkScheduler::mark_loaded(const ChunkIndex& index)
+{
+    requested.erase(index);
+    ready.insert(index);
+    wake(index);
+}
+
+void ChunkScheduler::clear()
+{
+    ready.clear();
+    waiters.clear();
+    hidden.clear();
+    requested.clear();
+}
@@ -0,0 +1,98 @@
+#ifndef CHUNK_SCHEDULER_H
+#define CHUNK_SCHEDULER_H
+
+#include "chunk.h"
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// 区块生命周期调度（主线程）
+//
+// Chunk::stage 记录区块已完成的生命周期阶段（见 ChunkStage），方块或光照被标记更新时由 Chunk 自己退回，
+// 并经 Chunk::attach_scheduler 挂接的调度器把自己放入待推进队列（编辑方块、邻居失效、跨区块光照都走这条路径）。
+// Terrain 不再每帧轮询整个渲染范围，其余可能改变区块状态的事件由 Terrain 通知：
+//   区块载入（生成完成、从缓存或存档读回）、移入渲染范围、mesh 上传完成
+// 推进区块时某个输入尚未就绪，就登记依赖而不是留在队列里反复检查：
+//   STAGE_LIT → STAGE_NEIGHBOUR_LIT  等待缺失或尚未完成内部光照的邻居（wait_for），邻居载入或完成内部光照时 wake()
+//   构建 mesh                          不在视野内的区块放入 hidden，每帧只检查这些区块是否进入视野（reveal）
+// 每帧的工作量只与状态发生变化的区块数有关，与渲染范围无关；没有事件的帧不做任何区块簿记。
+// 已提交生成、尚未载入的区块记为 requested（生命周期的 Requested 阶段）。
+class ChunkScheduler
+{
+    public:
+        typedef std::pair<int, int> ChunkIndex;
+
+    private:
+        std::set<ChunkIndex> ready;                                 // 待推进的区块（去重）
+        std::map<ChunkIndex, std::vector<ChunkIndex>> waiters;      // 尚未就绪的区块 → 等待它的区块
+        std::set<ChunkIndex> hidden;                                // 等待进入视野后构建 mesh
+        std::set<ChunkIndex> requested;                             // 已提交生成、尚未载入
+
+    public:
+        ChunkScheduler(){};
+
+        // 区块状态可能已变化，放入待推进队列
+        void notify(const ChunkIndex& index) { ready.insert(index); }
+
+        // 取出全部待推进的区块（由调用方排优先级，未处理完的重新 notify），队列为空时返回 false
+        bool take_ready(std::vector<ChunkIndex>& out);
+
+        // index 要等 dependency 载入并完成内部光照后才能继续推进
+        void wait_for(const ChunkIndex& dependency, const ChunkIndex& index);
+
+        // dependency 已载入或已完成内部光照：等待它的区块重新排队
+        void wake(const ChunkIndex& dependency);
+
+        // 区块需要构建 mesh 但不在视野内
+        void hide(const ChunkIndex& index) { hidden.insert(index); }
+
+        // 已进入视野的 hidden 区块重新排队：visible(const ChunkIndex&) 返回 true 表示可见
+        template<class Visible> void reveal(Visible visible)
+        {
+            for(auto it = hidden.begin(); it != hidden.end(); )
+            {
+                if(visible(*it))
+                {
+                    ready.insert(*it);
+                    it = hidden.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+
+        // 已提交生成
+        void mark_requested(const ChunkIndex& index) { requested.insert(index); }
+
+        // 区块已进入加载窗口：推进它，并唤醒等待它的区块
+        void mark_loaded(const ChunkIndex& index);
+
+        // 加载窗口移动后丢弃窗口外的记录：inside(const ChunkIndex&) 返回 true 表示仍在窗口内
+        // （重新进入窗口时会再次通知）
+        template<class Inside> void retain(Inside inside)
+        {
+            auto prune = [&](std::set<ChunkIndex>& s)
+            {
+                for(auto it = s.begin(); it != s.end(); )
+                    it = inside(*it) ? std::next(it) : s.erase(it);
+            };
+            prune(ready);
+            prune(hidden);
+            prune(requested);
+            for(auto it = waiters.begin(); it != waiters.end(); )
+                it = inside(it->first) ? std::next(it) : waiters.erase(it);
+        }
+
+        void clear();
+
+        size_t ready_count() const { return ready.size(); }
+        size_t waiting_count() const { return waiters.size(); }
+        size_t hidden_count() const { return hidden.size(); }
+        size_t requested_count() const { return requested.size(); }
+
+        ChunkScheduler(const ChunkScheduler&) = delete;
+        ChunkScheduler& operator=(const ChunkScheduler&) = delete;
+};
+
+#endif
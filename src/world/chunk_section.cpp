@@ -0,0 +1,179 @@
+#include "chunk_section.h"
+#include "chunk.h"
+#include <algorithm>
+
+using namespace std;
+
+void SectionMesh::create_face(const TerrainVertex& vertex1, const TerrainVertex& vertex2, const TerrainVertex& vertex3, const TerrainVertex& vertex4)
+{
+    vertices.push_back(vertex1);
+    vertices.push_back(vertex2);
+    vertices.push_back(vertex3);
+    vertices.push_back(vertex4);
+}
+
+void SectionMesh::create_face_transparent(const TerrainVertex& vertex1, const TerrainVertex& vertex2, const TerrainVertex& vertex3, const TerrainVertex& vertex4)
+{
+    verticesT.push_back(vertex1);
+    verticesT.push_back(vertex2);
+    verticesT.push_back(vertex3);
+    verticesT.push_back(vertex4);
+    indicesT.push_back((unsigned int)verticesT.size()-2);
+    indicesT.push_back((unsigned int)verticesT.size()-3);
+    indicesT.push_back((unsigned int)verticesT.size()-4);
+    indicesT.push_back((unsigned int)verticesT.size()-3);
+    indicesT.push_back((unsigned int)verticesT.size()-2);
+    indicesT.push_back((unsigned int)verticesT.size()-1);
+    // 记录面片中心用于每帧透明排序
+    transparentFaceCenters.push_back(
+        (vertex1.position() + vertex2.position() + vertex3.position() + vertex4.position()) * 0.25f);
+}
+
+void ChunkSection::apply_mesh(SectionMesh& mesh)
+{
+    if(!mesh.borderOnly)
+    {
+        // 完整构建：整体替换 CPU mesh
+        vertices.swap(mesh.vertices);
+        verticesT.swap(mesh.verticesT);
+        indicesT.swap(mesh.indicesT);
+        transparentFaceCenters.swap(mesh.transparentFaceCenters);
+        borderVertexStart = mesh.borderVertexStart;
+        borderVertexTStart = mesh.borderVertexTStart;
+        borderIndexTStart = mesh.borderIndexTStart;
+        borderFaceCenterStart = mesh.borderFaceCenterStart;
+
+        if(vertices.empty() && verticesT.empty())
+        {
+            release_mesh();
+            return;
+        }
+        update_bounds();
+        shrink_to_fit();
+        return;
+    }
+
+    // 边界刷新：截断到内部/边界分割点，丢弃旧的边界面片，再追加新的（索引需要 rebase）
+    vertices.resize(borderVertexStart);
+    verticesT.resize(borderVertexTStart);
+    indicesT.resize(borderIndexTStart);
+    transparentFaceCenters.resize(borderFaceCenterStart);
+
+    vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+    unsigned int offsetT = (unsigned int)verticesT.size();
+    verticesT.insert(verticesT.end(), mesh.verticesT.begin(), mesh.verticesT.end());
+    for(unsigned int idx : mesh.indicesT)
+        indicesT.push_back(idx + offsetT);
+    transparentFaceCenters.insert(transparentFaceCenters.end(),
+        mesh.transparentFaceCenters.begin(), mesh.transparentFaceCenters.end());
+
+    update_bounds();
+    shrink_to_fit();
+}
+
+bool ChunkSection::sort_transparent_faces(const glm::vec3& localCameraPos)
+{
+    int faceCount = (int)transparentFaceCenters.size();
+    if(faceCount <= 1) return false;
+
+    // 创建面片索引数组 [0, 1, ..., N-1]
+    vector<int> faceOrder(faceCount);
+    for(int i = 0; i < faceCount; i++) faceOrder[i] = i;
+
+    // 按距离摄像机从远到近排序
+    sort(faceOrder.begin(), faceOrder.end(), [&](int a, int b) {
+        glm::vec3 da = transparentFaceCenters[a] - localCameraPos;
+        glm::vec3 db = transparentFaceCenters[b] - localCameraPos;
+        return glm::dot(da, da) > glm::dot(db, db);
+    });
+
+    // 按排序顺序重建 indicesT（每个面片固定模式: base+2, base+1, base+0, base+1, base+2, base+3）
+    for(int i = 0; i < faceCount; i++)
+    {
+        unsigned int base = faceOrder[i] * 4;
+        indicesT[i*6+0] = base + 2;
+        indicesT[i*6+1] = base + 1;
+        indicesT[i*6+2] = base + 0;
+        indicesT[i*6+3] = base + 1;
+        indicesT[i*6+4] = base + 2;
+        indicesT[i*6+5] = base + 3;
+    }
+    return true;
+}
+
+void ChunkSection::update_bounds()
+{
+    if(vertices.empty() && verticesT.empty()) return;
+    glm::vec3 lo(1e9f), hi(-1e9f);
+    auto expand = [&](const vector<TerrainVertex>& verts)
+    {
+        for(const TerrainVertex& v : verts)
+        {
+            glm::vec3 p = v.position();
+            lo.x = std::min(lo.x, p.x); hi.x = std::max(hi.x, p.x);
+            lo.y = std::min(lo.y, p.y); hi.y = std::max(hi.y, p.y);
+            lo.z = std::min(lo.z, p.z); hi.z = std::max(hi.z, p.z);
+        }
+    };
+    expand(vertices);
+    expand(verticesT);
+    aabbMin = lo;
+    aabbMax = hi;
+}
+
+void ChunkSection::shrink_to_fit()
+{
+    vertices.shrink_to_fit();
+    verticesT.shrink_to_fit();
+    indicesT.shrink_to_fit();
+}
+
+void ChunkSection::release_mesh()
+{
+    vector<TerrainVertex>().swap(vertices);
+    vector<TerrainVertex>().swap(verticesT);
+    vector<unsigned int>().swap(indicesT);
+    vector<glm::vec3>().swap(transparentFaceCenters);
+    borderVertexStart = 0;
+    borderVertexTStart = borderIndexTStart = 0;
+    borderFaceCenterStart = 0;
+}
+
+ChunkSection::ChunkSection(ChunkSection&& other) noexcept
+    : vertices(std::move(other.vertices)),
+      verticesT(std::move(other.verticesT)),
+      transparentFaceCenters(std::move(other.transparentFaceCenters)),
+      indicesT(std::move(other.indicesT)),
+      borderVertexStart(other.borderVertexStart),
+      borderVertexTStart(other.borderVertexTStart),
+      borderIndexTStart(other.borderIndexTStart),
+      borderFaceCenterStart(other.borderFaceCenterStart),
+      meshUpdate(other.meshUpdate),
+      aabbMin(other.aabbMin),
+      aabbMax(other.aabbMax)
+{
+    other.meshUpdate = MESH_NONE;
+}
+
+ChunkSection& ChunkSection::operator=(ChunkSection&& other) noexcept
+{
+    if (this != &other)  // 防止自赋值
+    {
+        // 窃取源对象资源
+        vertices = std::move(other.vertices);
+        verticesT = std::move(other.verticesT);
+        transparentFaceCenters = std::move(other.transparentFaceCenters);
+        indicesT = std::move(other.indicesT);
+        borderVertexStart = other.borderVertexStart;
+        borderVertexTStart = other.borderVertexTStart;
+        borderIndexTStart = other.borderIndexTStart;
+        borderFaceCenterStart = other.borderFaceCenterStart;
+        meshUpdate = other.meshUpdate;
+        aabbMin = other.aabbMin;
+        aabbMax = other.aabbMax;
+
+        // 源对象置空
+        other.meshUpdate = MESH_NONE;
+    }
+    return *this;
+}
@@ -0,0 +1,94 @@
+#ifndef CHUNK_SECTION_H
+#define CHUNK_SECTION_H
+
+#include <glm/glm.hpp>
+#include "../render/basic_struct.h"
+#include <vector>
+
+// 邻居区块 mesh 更新等级
+// MESH_NONE           : 无需更新
+// MESH_BORDER_REFRESH : 仅重建边界面片（邻居方块变化导致边界面片需要更新）
+// MESH_FULL_REBUILD   : 完整重建所有面片（本区块方块变化）
+enum MeshUpdateLevel { MESH_NONE = 0, MESH_BORDER_REFRESH = 1, MESH_FULL_REBUILD = 2 };
+
+// 单个分段的 CPU mesh 构建结果（工作线程生成，主线程经 Chunk::apply_mesh 并入分段，再由 Terrain 上传）
+struct SectionMesh
+{
+    int section = 0;                                // 分段编号
+    bool borderOnly = false;                        // 仅含边界面片：替换分段原有的边界部分，内部面片不动
+
+    std::vector<TerrainVertex> vertices;
+    std::vector<TerrainVertex> verticesT;
+    std::vector<glm::vec3> transparentFaceCenters;
+    std::vector<unsigned int> indicesT;             // 不透明面片使用共享四边形索引，无需逐分段索引
+
+    // 内部/边界面片分割点（仅完整构建时有效）
+    size_t borderVertexStart = 0;
+    size_t borderVertexTStart = 0;
+    size_t borderIndexTStart = 0;
+    size_t borderFaceCenterStart = 0;
+
+    void create_face(const TerrainVertex& vertex1, const TerrainVertex& vertex2, const TerrainVertex& vertex3, const TerrainVertex& vertex4);
+    void create_face_transparent(const TerrainVertex& vertex1, const TerrainVertex& vertex2, const TerrainVertex& vertex3, const TerrainVertex& vertex4);
+
+    // 上传到 GPU 的数据量（字节），用于主线程的每帧上传预算
+    size_t byte_size() const
+    {
+        return (vertices.size() + verticesT.size()) * sizeof(TerrainVertex)
+             + indicesT.size() * sizeof(unsigned int);
+    }
+};
+
+// 区块的垂直分段（CHUNK_SIZE × SECTION_HEIGHT × CHUNK_SIZE）
+// 每个分段拥有独立的 CPU mesh、脏标记和 AABB（方块与光照见 ChunkSlice，显存区间与 GL 缓冲见 SectionRenderData），
+// 方块修改只需重建所在分段；全空气分段不参与 mesh 构建、光照 BFS 和视锥测试。
+// 分段不持有任何 GL 资源，可以在任意线程创建、移动和销毁。
+class ChunkSection
+{
+    public:
+        std::vector<TerrainVertex> vertices;
+        std::vector<TerrainVertex> verticesT;           // 透明方块顶点数据
+        std::vector<glm::vec3> transparentFaceCenters;  // 每个透明面片的中心（chunk局部空间）
+        std::vector<unsigned int> indicesT;             // 透明方块索引数据（每帧按距离重排）
+
+        // 内部/边界面片分割点（mesh 构建时记录）
+        size_t borderVertexStart = 0;
+        size_t borderVertexTStart = 0;
+        size_t borderIndexTStart = 0;
+        size_t borderFaceCenterStart = 0;
+
+        MeshUpdateLevel meshUpdate = MESH_NONE;         // 分段 mesh 更新等级
+        glm::vec3 aabbMin = glm::vec3(0.0f);            // 分段几何包围盒（chunk局部空间）
+        glm::vec3 aabbMax = glm::vec3(0.0f);
+
+        ChunkSection() {}
+
+        // 不透明面片的绘制索引数（每个面 4 顶点、6 索引）
+        unsigned int index_count() const { return (unsigned int)(vertices.size() / 4 * 6); }
+
+        // 并入工作线程构建的 mesh（只改 CPU 数据，上传见 SectionRenderData）
+        void apply_mesh(SectionMesh& mesh);
+
+        // 透明面片按到摄像机的距离从远到近重排索引，返回索引是否需要重传
+        bool sort_transparent_faces(const glm::vec3& localCameraPos);
+
+        // 由当前顶点重新计算紧凑包围盒（无几何时保持原值）
+        void update_bounds();
+
+        // 清空 CPU mesh（分段变为全空气或区块归还显存时调用）
+        void release_mesh();
+
+        // 禁用拷贝
+        ChunkSection(const ChunkSection&) = delete;
+        ChunkSection& operator=(const ChunkSection&) = delete;
+
+        // 启用移动
+        ChunkSection(ChunkSection&& other) noexcept;
+        ChunkSection& operator=(ChunkSection&& other) noexcept;
+
+    private:
+        // 构建完成后收回多余容量（分段 mesh 常驻内存）
+        void shrink_to_fit();
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "climate_cache.h"
+
+using namespace std;
+
+void ClimateCache::init(PerlinNoise* noise, int cellSize, size_t maxTiles)
+{
+    clear();
+    perlinNoise = noise;
+    cellShift = 0;
+    while(cellShift < CLIMATE_TILE_SHIFT && (2 << cellShift) <= cellSize)
+        cellShift++;
+    points = (CLIMATE_TILE_SIZE >> cellShift) + 1;
+    capacity = max<size_t>(1, maxTiles);
+}
+
+void ClimateCache::clear()
+{
+    lock_guard<mutex> lock(mtx);
+    tiles.clear();
+    lru.clear();
+    hits = 0;
+    misses = 0;
+}
+
+size_t ClimateCache::tile_count()
+{
+    lock_guard<mutex> lock(mtx);
+    return tiles.size();
+}
+
+shared_ptr<ClimateCache::Tile> ClimateCache::acquire(const TileIndex& index)
+{
+    shared_ptr<Tile> tile;
+    {
+        lock_guard<mutex> lock(mtx);
+        auto it = tiles.find(index);
+        if(it != tiles.end())
+        {
+            lru.splice(lru.begin(), lru, it->second);
+            tile = it->second->second;
+            hits++;
+        }
+        else
+        {
+            tile = make_shared<Tile>();
+            lru.emplace_front(index, tile);
+            tiles[index] = lru.begin();
+            if(tiles.size() > capacity)
+            {
+                tiles.erase(lru.back().first);
+                lru.pop_back();
+            }
+            misses++;
+        }
+    }
+    // 在锁外填充，其他线程可以同时读取别的瓦片；同一瓦片只填充一次
+    call_once(tile->filled, [&]() { fill(*tile, index); });
+    return tile;
+}
+
+void ClimateCache::fill(Tile& tile, const TileIndex& index)
+{
+    // 频率与偏移同 Chunk::generate_height，格点取整数世界坐标
+    int cell = 1 << cellShift;
+    double originX = (double)index.first * CLIMATE_TILE_SIZE;
+    double originZ = (double)index.second * CLIMATE_TILE_SIZE;
+    tile.continental.resize((size_t)points * points);
+    tile.erosion.resize((size_t)points * points);
+
+    vector<double> xs(points);
+    for(int gz = 0; gz < points; gz++)
+    {
+        double worldZ = originZ + gz * cell;
+        for(int gx = 0; gx < points; gx++)
+            xs[gx] = (originX + gx * cell) * 0.005;
+        perlinNoise->get_fbm_noise_batch(xs.data(), worldZ * 0.005, points, 4, 0.5, 2.0, &tile.continental[(size_t)gz * points]);
+        for(int gx = 0; gx < points; gx++)
+            xs[gx] = (originX + gx * cell) * 0.008 + 1000.0f;
+        perlinNoise->get_fbm_noise_batch(xs.data(), worldZ * 0.008 + 1000.0f, points, 4, 0.5, 2.0, &tile.erosion[(size_t)gz * points]);
+    }
+}
+
+void ClimateCache::sample_row(int worldX, int worldZ, int count, double* continental, double* erosion)
+{
+    int cellMask = (1 << cellShift) - 1;
+    double invCell = 1.0 / (1 << cellShift);
+
+    // 算术右移即向下取整，负坐标同样适用
+    int localZ = worldZ & (CLIMATE_TILE_SIZE - 1);
+    int gz = localZ >> cellShift;
+    double tz = (localZ & cellMask) * invCell;
+
+    int j = 0;
+    while(j < count)
+    {
+        // 一行最多跨两个瓦片：每个瓦片取一次
+        int x = worldX + j;
+        shared_ptr<Tile> tile = acquire({x >> CLIMATE_TILE_SHIFT, worldZ >> CLIMATE_TILE_SHIFT});
+        const double* c0 = &tile->continental[(size_t)gz * points];
+        const double* c1 = c0 + points;
+        const double* e0 = &tile->erosion[(size_t)gz * points];
+        const double* e1 = e0 + points;
+        for(int localX = x & (CLIMATE_TILE_SIZE - 1); j < count && localX < CLIMATE_TILE_SIZE; j++, localX++)
+        {
+            int gx = localX >> cellShift;
+            double tx = (localX & cellMask) * invCell;
+            double a = c0[gx] + tx * (c0[gx + 1] - c0[gx]);
+            double b = c1[gx] + tx * (c1[gx + 1] - c1[gx]);
+            continental[j] = a + tz * (b - a);
+            a = e0[gx] + tx * (e0[gx + 1] - e0[gx]);
+            b = e1[gx] + tx * (e1[gx + 1] - e1[gx]);
+            erosion[j] = a + tz * (b - a);
+        }
+    }
+}
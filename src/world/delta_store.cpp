@@ -0,0 +1,114 @@
+#include "delta_store.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace std;
+
+bool DeltaStore::open(const string& dir, uint32_t generatorId)
+{
+    close();
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    if(ec) return false;
+
+    string file = dir + "/" + DELTA_FILE_NAME;
+    map<ChunkIndex, vector<uint32_t>> loaded;
+    ifstream in(file, ios::binary);
+    if(in)
+    {
+        uint32_t head[4];
+        if(!in.read((char*)head, sizeof(head)) || head[0] != DELTA_MAGIC || head[1] != DELTA_VERSION ||
+           head[2] != generatorId)
+            return false;
+        for(uint32_t c = 0; c < head[3]; c++)
+        {
+            int32_t index[2];
+            uint32_t count;
+            if(!in.read((char*)index, sizeof(index)) || !in.read((char*)&count, sizeof(count)) ||
+               count > CHUNK_SIZE * CHUNK_SIZE * CHUNK_HEIGHT)
+                return false;
+            vector<uint32_t>& edits = loaded[{index[0], index[1]}];
+            edits.resize(count);
+            if(!in.read((char*)edits.data(), count * sizeof(uint32_t)))
+                return false;
+        }
+    }
+
+    lock_guard<mutex> lock(mtx);
+    deltas.swap(loaded);
+    path = file;
+    generator = generatorId;
+    dirty = false;
+    return true;
+}
+
+void DeltaStore::close()
+{
+    lock_guard<mutex> lock(mtx);
+    deltas.clear();
+    path.clear();
+    dirty = false;
+}
+
+bool DeltaStore::edits_of(const ChunkIndex& index, vector<uint32_t>& out) const
+{
+    lock_guard<mutex> lock(mtx);
+    auto it = deltas.find(index);
+    if(it == deltas.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void DeltaStore::record(const ChunkIndex& index, Chunk& chunk)
+{
+    lock_guard<mutex> lock(mtx);
+    if(!chunk.edits.empty())
+    {
+        deltas[index] = chunk.edits;
+        dirty = true;
+    }
+    chunk.modified = false;
+}
+
+bool DeltaStore::flush()
+{
+    lock_guard<mutex> lock(mtx);
+    if(path.empty() || !dirty) return true;
+
+    // 先写临时文件再替换，写入中途失败不会破坏原存档
+    string temp = path + ".tmp";
+    {
+        ofstream out(temp, ios::binary | ios::trunc);
+        uint32_t head[4] = {DELTA_MAGIC, DELTA_VERSION, generator, (uint32_t)deltas.size()};
+        out.write((const char*)head, sizeof(head));
+        for(auto& d : deltas)
+        {
+            int32_t index[2] = {d.first.first, d.first.second};
+            uint32_t count = (uint32_t)d.second.size();
+            out.write((const char*)index, sizeof(index));
+            out.write((const char*)&count, sizeof(count));
+            out.write((const char*)d.second.data(), count * sizeof(uint32_t));
+        }
+        if(!out) return false;
+    }
+    error_code ec;
+    filesystem::rename(temp, path, ec);
+    if(ec) return false;
+    dirty = false;
+    return true;
+}
+
+size_t DeltaStore::chunk_count() const
+{
+    lock_guard<mutex> lock(mtx);
+    return deltas.size();
+}
+
+size_t DeltaStore::edit_count() const
+{
+    lock_guard<mutex> lock(mtx);
+    size_t count = 0;
+    for(auto& d : deltas)
+        count += d.second.size();
+    return count;
+}
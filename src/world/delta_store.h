@@ -0,0 +1,60 @@
+#ifndef DELTA_STORE_H
+#define DELTA_STORE_H
+
+#include "chunk.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define DELTA_MAGIC 0x544C4544u                         // "DELT"
+#define DELTA_VERSION 2
+#define DELTA_FILE_NAME "edits.delta"
+
+// 增量存档：只保存玩家的编辑记录
+//
+// 地形是种子的确定函数，区块本身无需保存。每个区块只记录 Chunk::edits（按下标升序的
+// (voxelIdx << 8 | 方块类型)），读取时由噪声重新生成区块并在计算光照前一次性重放。
+// 全部记录常驻内存，flush() 整体写入临时文件后替换原文件，轻度编辑的世界只有几 KB。
+// 文件布局（小端）：[magic u32][version u32][生成器标识 u32][区块数 u32]，随后每个区块 [x i32][z i32][记录数 u32][记录 u32 × n]
+// 生成器标识（WorldGenSettings::generator_id）与当前不同的存档拒绝读取：编辑只有重放到原来的地形上才有意义。
+// edits_of 可在生成线程上并发调用，其余接口在主线程调用。
+class DeltaStore
+{
+    public:
+        typedef std::pair<int, int> ChunkIndex;
+
+    private:
+        std::string path;
+        uint32_t generator = 0;                         // 写入文件头的生成器标识
+        std::map<ChunkIndex, std::vector<uint32_t>> deltas;
+        mutable std::mutex mtx;
+        bool dirty = false;                             // 内存中的记录比文件新
+
+    public:
+        DeltaStore(){};
+
+        // 打开存档目录下的增量文件（不存在时视为空存档），文件损坏或由其他生成器标识写入时返回 false
+        bool open(const std::string& dir, uint32_t generatorId);
+        void close();
+        bool is_open() const { return !path.empty(); }
+
+        // 取出区块的编辑记录，没有记录返回 false
+        bool edits_of(const ChunkIndex& index, std::vector<uint32_t>& out) const;
+
+        // 更新区块的编辑记录（内存中），成功后区块标记为已保存
+        void record(const ChunkIndex& index, Chunk& chunk);
+
+        // 有变化时写回文件
+        bool flush();
+
+        size_t chunk_count() const;
+        size_t edit_count() const;
+
+        DeltaStore(const DeltaStore&) = delete;
+        DeltaStore& operator=(const DeltaStore&) = delete;
+};
+
+#endif
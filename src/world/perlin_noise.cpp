@@ -0,0 +1,266 @@
+#include "perlin_noise.h"
+
+// 批量版本须与单点版本逐位一致：禁止 GCC 把乘加合并为 FMA（改变舍入）
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PERLIN_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang 按函数开启 AVX2 + FMA，其余代码仍按基础指令集编译，由运行时检测决定是否调用
+#if defined(PERLIN_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PERLIN_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define PERLIN_TARGET_AVX2
+#endif
+
+static bool detect_avx2()
+{
+#if !defined(PERLIN_SIMD_X86)
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if(!osxsave || !avx || !fma || (_xgetbv(0) & 6) != 6) return false;   // 操作系统需保存 YMM 寄存器
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+bool PerlinNoise::simd_supported()
+{
+    static const bool supported = detect_avx2();
+    return supported;
+}
+
+#if defined(PERLIN_SIMD_X86)
+
+// fast_dot / fast_dot_3D 的梯度表：与 switch 分支逐项对应，乘 ±1 / 0 后相加与原表达式的浮点结果相同
+alignas(16) static const float grad2X[8] = { 1, -1,  1, -1,  1, -1,  0,  0};
+alignas(16) static const float grad2Y[8] = { 1,  1, -1, -1,  0,  0,  1, -1};
+alignas(16) static const float grad3X[16] = { 1, -1,  1, -1,  1, -1,  1, -1,  0,  0,  0,  0,  0, 0, 0, 0};
+alignas(16) static const float grad3Y[16] = { 1,  1, -1, -1,  0,  0,  0,  0,  1, -1,  1, -1,  0, 0, 0, 0};
+alignas(16) static const float grad3Z[16] = { 0,  0,  0,  0,  1,  1, -1, -1,  1,  1, -1, -1,  0, 0, 0, 0};
+
+// (hi, lo) × t：双-双精度乘法，FMA 求出乘积的精确舍入误差
+PERLIN_TARGET_AVX2 static inline void mul_dd_avx2(__m256d& hi, __m256d& lo, __m256d t)
+{
+    __m256d p = _mm256_mul_pd(hi, t);
+    __m256d e = _mm256_add_pd(_mm256_fmsub_pd(hi, t, p), _mm256_mul_pd(lo, t));
+    hi = _mm256_add_pd(p, e);
+    lo = _mm256_sub_pd(e, _mm256_sub_pd(hi, p));
+}
+
+PERLIN_TARGET_AVX2 static inline __m256d fade_avx2(__m256d t)
+{
+    // pow(t, n) 的结果接近正确舍入，连乘会累积多次舍入误差；
+    // 这里用双-双精度求幂后只舍入一次，与 pow 的结果几乎总是逐位相同
+    __m256d hi = _mm256_mul_pd(t, t);
+    __m256d lo = _mm256_fmsub_pd(t, t, hi);
+    mul_dd_avx2(hi, lo, t);
+    __m256d t3 = hi;
+    mul_dd_avx2(hi, lo, t);
+    __m256d t4 = hi;
+    mul_dd_avx2(hi, lo, t);
+    __m256d t5 = hi;
+
+    // 6t^5 - 15t^4 + 10t^3，运算顺序同 fade
+    __m256d r = _mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(6.0), t5), _mm256_mul_pd(_mm256_set1_pd(15.0), t4));
+    return _mm256_add_pd(r, _mm256_mul_pd(_mm256_set1_pd(10.0), t3));
+}
+
+PERLIN_TARGET_AVX2 static inline __m256d lerp_avx2(__m256d a, __m256d b, __m256d t)
+{
+    return _mm256_add_pd(a, _mm256_mul_pd(t, _mm256_sub_pd(b, a)));
+}
+
+PERLIN_TARGET_AVX2 static inline __m128i perm_at(const int* perm, __m128i idx)
+{
+    return _mm_i32gather_epi32(perm, idx, 4);
+}
+
+// 单点版本中到角点的向量存放在 glm::vec2/vec3（单精度），点积在单精度下完成后再转回双精度
+PERLIN_TARGET_AVX2 static inline __m256d dot2_avx2(__m128i hash, __m128 dx, __m128 dy)
+{
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(0x7));
+    __m128 gx = _mm_i32gather_ps(grad2X, h, 4);
+    __m128 gy = _mm_i32gather_ps(grad2Y, h, 4);
+    return _mm256_cvtps_pd(_mm_add_ps(_mm_mul_ps(gx, dx), _mm_mul_ps(gy, dy)));
+}
+
+PERLIN_TARGET_AVX2 static inline __m256d dot3_avx2(__m128i hash, __m128 dx, __m128 dy, __m128 dz)
+{
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(0xF));
+    __m128 gx = _mm_i32gather_ps(grad3X, h, 4);
+    __m128 gy = _mm_i32gather_ps(grad3Y, h, 4);
+    __m128 gz = _mm_i32gather_ps(grad3Z, h, 4);
+    return _mm256_cvtps_pd(_mm_add_ps(_mm_add_ps(_mm_mul_ps(gx, dx), _mm_mul_ps(gy, dy)), _mm_mul_ps(gz, dz)));
+}
+
+// 4 个采样的 get_2D_perlin_noice
+PERLIN_TARGET_AVX2 static __m256d noise2_avx2(const int* perm, __m256d x, __m256d y)
+{
+    const __m128i mask = _mm_set1_epi32(255);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m256d oneD = _mm256_set1_pd(1.0);
+
+    __m256d fx = _mm256_floor_pd(x), fy = _mm256_floor_pd(y);
+    __m128i xi = _mm_and_si128(_mm256_cvttpd_epi32(fx), mask);
+    __m128i yi = _mm_and_si128(_mm256_cvttpd_epi32(fy), mask);
+    __m256d xf = _mm256_sub_pd(x, fx), yf = _mm256_sub_pd(y, fy);
+
+    __m128i a = _mm_add_epi32(perm_at(perm, xi), yi);
+    __m128i b = _mm_add_epi32(perm_at(perm, _mm_add_epi32(xi, one)), yi);
+    __m128i aa = perm_at(perm, a);
+    __m128i ab = perm_at(perm, _mm_add_epi32(a, one));
+    __m128i ba = perm_at(perm, b);
+    __m128i bb = perm_at(perm, _mm_add_epi32(b, one));
+
+    __m128 dx0 = _mm256_cvtpd_ps(xf), dx1 = _mm256_cvtpd_ps(_mm256_sub_pd(xf, oneD));
+    __m128 dy0 = _mm256_cvtpd_ps(yf), dy1 = _mm256_cvtpd_ps(_mm256_sub_pd(yf, oneD));
+
+    __m256d v1 = dot2_avx2(aa, dx0, dy0);
+    __m256d v2 = dot2_avx2(ab, dx0, dy1);
+    __m256d v3 = dot2_avx2(ba, dx1, dy0);
+    __m256d v4 = dot2_avx2(bb, dx1, dy1);
+
+    __m256d u = fade_avx2(xf), v = fade_avx2(yf);
+    __m256d v12 = lerp_avx2(v1, v2, v);
+    __m256d v34 = lerp_avx2(v3, v4, v);
+    return lerp_avx2(v12, v34, u);
+}
+
+// 4 个采样的 get_3D_perlin_noice
+PERLIN_TARGET_AVX2 static __m256d noise3_avx2(const int* perm, __m256d x, __m256d y, __m256d z)
+{
+    const __m128i mask = _mm_set1_epi32(255);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m256d oneD = _mm256_set1_pd(1.0);
+
+    __m256d fx = _mm256_floor_pd(x), fy = _mm256_floor_pd(y), fz = _mm256_floor_pd(z);
+    __m128i xi = _mm_and_si128(_mm256_cvttpd_epi32(fx), mask);
+    __m128i yi = _mm_and_si128(_mm256_cvttpd_epi32(fy), mask);
+    __m128i zi = _mm_and_si128(_mm256_cvttpd_epi32(fz), mask);
+    __m256d xf = _mm256_sub_pd(x, fx), yf = _mm256_sub_pd(y, fy), zf = _mm256_sub_pd(z, fz);
+
+    __m128i a = _mm_add_epi32(perm_at(perm, xi), yi);
+    __m128i b = _mm_add_epi32(perm_at(perm, _mm_add_epi32(xi, one)), yi);
+    __m128i aa = _mm_add_epi32(perm_at(perm, a), zi);
+    __m128i ab = _mm_add_epi32(perm_at(perm, _mm_add_epi32(a, one)), zi);
+    __m128i ba = _mm_add_epi32(perm_at(perm, b), zi);
+    __m128i bb = _mm_add_epi32(perm_at(perm, _mm_add_epi32(b, one)), zi);
+
+    __m128 dx0 = _mm256_cvtpd_ps(xf), dx1 = _mm256_cvtpd_ps(_mm256_sub_pd(xf, oneD));
+    __m128 dy0 = _mm256_cvtpd_ps(yf), dy1 = _mm256_cvtpd_ps(_mm256_sub_pd(yf, oneD));
+    __m128 dz0 = _mm256_cvtpd_ps(zf), dz1 = _mm256_cvtpd_ps(_mm256_sub_pd(zf, oneD));
+
+    __m256d n000 = dot3_avx2(perm_at(perm, aa), dx0, dy0, dz0);
+    __m256d n001 = dot3_avx2(perm_at(perm, _mm_add_epi32(aa, one)), dx0, dy0, dz1);
+    __m256d n010 = dot3_avx2(perm_at(perm, ab), dx0, dy1, dz0);
+    __m256d n011 = dot3_avx2(perm_at(perm, _mm_add_epi32(ab, one)), dx0, dy1, dz1);
+    __m256d n100 = dot3_avx2(perm_at(perm, ba), dx1, dy0, dz0);
+    __m256d n101 = dot3_avx2(perm_at(perm, _mm_add_epi32(ba, one)), dx1, dy0, dz1);
+    __m256d n110 = dot3_avx2(perm_at(perm, bb), dx1, dy1, dz0);
+    __m256d n111 = dot3_avx2(perm_at(perm, _mm_add_epi32(bb, one)), dx1, dy1, dz1);
+
+    __m256d u = fade_avx2(xf), v = fade_avx2(yf), w = fade_avx2(zf);
+    __m256d x00 = lerp_avx2(n000, n100, u);
+    __m256d x01 = lerp_avx2(n001, n101, u);
+    __m256d x10 = lerp_avx2(n010, n110, u);
+    __m256d x11 = lerp_avx2(n011, n111, u);
+    __m256d y0 = lerp_avx2(x00, x10, v);
+    __m256d y1 = lerp_avx2(x01, x11, v);
+    return lerp_avx2(y0, y1, w);
+}
+
+// 返回已处理的采样数（4 的倍数），剩余部分由调用方逐点计算
+PERLIN_TARGET_AVX2 static int fbm_batch_avx2(const int* perm, const double* xs, double y, int count,
+    int octaves, double persistence, double lacunarity, double* out)
+{
+    int n = 0;
+    for(; n + 4 <= count; n += 4)
+    {
+        __m256d x = _mm256_loadu_pd(xs + n);
+        __m256d total = _mm256_setzero_pd();
+        double amplitude = 1.0;
+        double frequency = 1.0;
+        double maxValue = 0.0;
+        for(int i = 0; i < octaves; i++)
+        {
+            __m256d f = _mm256_set1_pd(frequency);
+            __m256d noise = noise2_avx2(perm, _mm256_mul_pd(x, f), _mm256_set1_pd(y * frequency));
+            total = _mm256_add_pd(total, _mm256_mul_pd(noise, _mm256_set1_pd(amplitude)));
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= lacunarity;
+        }
+        _mm256_storeu_pd(out + n, _mm256_div_pd(total, _mm256_set1_pd(maxValue)));
+    }
+    return n;
+}
+
+PERLIN_TARGET_AVX2 static int noise2_batch_avx2(const int* perm, const double* xs, double y, int count, double* out)
+{
+    int n = 0;
+    for(; n + 4 <= count; n += 4)
+        _mm256_storeu_pd(out + n, noise2_avx2(perm, _mm256_loadu_pd(xs + n), _mm256_set1_pd(y)));
+    return n;
+}
+
+PERLIN_TARGET_AVX2 static int noise3_batch_avx2(const int* perm, double x, double y, const double* zs, int count, double* out)
+{
+    int n = 0;
+    __m256d vx = _mm256_set1_pd(x), vy = _mm256_set1_pd(y);
+    for(; n + 4 <= count; n += 4)
+        _mm256_storeu_pd(out + n, noise3_avx2(perm, vx, vy, _mm256_loadu_pd(zs + n)));
+    return n;
+}
+
+#endif
+
+void PerlinNoise::get_2D_perlin_noise_batch(const double* xs, double y, int count, double* out)
+{
+    int n = 0;
+#if defined(PERLIN_SIMD_X86)
+    if(simd_supported())
+        n = noise2_batch_avx2(perm, xs, y, count, out);
+#endif
+    for(; n < count; n++)
+        out[n] = get_2D_perlin_noice(xs[n], y);
+}
+
+void PerlinNoise::get_fbm_noise_batch(const double* xs, double y, int count, int octaves, double persistence, double lacunarity, double* out)
+{
+    int n = 0;
+#if defined(PERLIN_SIMD_X86)
+    if(simd_supported())
+        n = fbm_batch_avx2(perm, xs, y, count, octaves, persistence, lacunarity, out);
+#endif
+    for(; n < count; n++)
+        out[n] = get_fbm_noise(xs[n], y, octaves, persistence, lacunarity);
+}
+
+void PerlinNoise::get_3D_perlin_noise_batch(double x, double y, const double* zs, int count, double* out)
+{
+    int n = 0;
+#if defined(PERLIN_SIMD_X86)
+    if(simd_supported())
+        n = noise3_batch_avx2(perm, x, y, zs, count, out);
+#endif
+    for(; n < count; n++)
+        out[n] = get_3D_perlin_noice(x, y, zs[n]);
+}
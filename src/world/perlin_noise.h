@@ -7,6 +7,7 @@
 #include<vector>
 #include<stdlib.h>
 #include<math.h>
+#include "world_rng.h"
 
 using namespace std;
 class PerlinNoise
@@ -30,12 +31,16 @@ public:
 
     void set_seed(int seed)
     {
-        // 根据设定的随机数种子进行打乱
+        // 根据设定的随机数种子打乱（Fisher-Yates），只由种子决定，与调用次数和全局随机状态无关
         this->seed = seed;
-        srand(this->seed);
-        for(int i = 0; i < 256; i++) 
+        for(int i = 0; i < 256; i++)
+        {
+            perm[i] = i;
+        }
+        WorldRng rng(seed, 0, 0, RNG_PERMUTATION);
+        for(int i = 255; i > 0; i--)
         {
-            int j = rand() % 256;
+            int j = (int)rng.next_below(i + 1);
             swap(perm[i], perm[j]);
         }
         
@@ -46,6 +51,11 @@ public:
         }
     }
 
+    int get_seed() const
+    {
+        return seed;
+    }
+
     double get_2D_perlin_noice(double x, double y)
     {
         int xi = (int)floor(x) & 255;
@@ -201,6 +211,22 @@ public:
         return result;
     }
 
+    // ============ 批量接口 ============
+    // 一次计算一行（或一列）采样，逐项等价于对应的单点函数。
+    // CPU 支持 AVX2 时每次并行计算 4 个采样（双精度，浮点运算顺序与单点版本一致），否则逐点回退到单点版本；
+    // 两条路径的差别只来自 fade 中 pow 与连乘的舍入（约 1e-16），不会改变已有种子生成的世界。
+
+    // out[n] = get_2D_perlin_noice(xs[n], y)
+    void get_2D_perlin_noise_batch(const double* xs, double y, int count, double* out);
+
+    // out[n] = get_fbm_noise(xs[n], y, octaves, persistence, lacunarity)
+    void get_fbm_noise_batch(const double* xs, double y, int count, int octaves, double persistence, double lacunarity, double* out);
+
+    // out[n] = get_3D_perlin_noice(x, y, zs[n])
+    void get_3D_perlin_noise_batch(double x, double y, const double* zs, int count, double* out);
+
+    // 批量接口是否使用 AVX2（运行时检测一次）
+    static bool simd_supported();
 };
 
 #endif
\ No newline at end of file
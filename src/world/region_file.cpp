@@ -0,0 +1,279 @@
+#include "region_file.h"
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// 按偏移读写的平台封装：读写都显式给出偏移，不依赖共享的文件指针。
+// 句柄保存为 intptr_t，POSIX 下为文件描述符，Windows 下为 HANDLE（INVALID_HANDLE_VALUE 与 -1 相同）。
+// 读写返回实际字节数，出错返回 -1（读到文件末尾返回 0）
+#ifdef _WIN32
+static intptr_t open_file(const string& path, bool writable)
+{
+    HANDLE file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    return (intptr_t)file;
+}
+
+static int64_t read_at(intptr_t file, void* data, size_t size, uint64_t offset)
+{
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD done = 0;
+    if(!ReadFile((HANDLE)file, data, (DWORD)size, &done, &overlapped))
+        return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+    return done;
+}
+
+static int64_t write_at(intptr_t file, const void* data, size_t size, uint64_t offset)
+{
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD done = 0;
+    if(!WriteFile((HANDLE)file, data, (DWORD)size, &done, &overlapped))
+        return -1;
+    return done;
+}
+
+static void close_file(intptr_t file)
+{
+    CloseHandle((HANDLE)file);
+}
+#else
+static intptr_t open_file(const string& path, bool writable)
+{
+    return ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+}
+
+static int64_t read_at(intptr_t file, void* data, size_t size, uint64_t offset)
+{
+    return pread((int)file, data, size, (off_t)offset);
+}
+
+static int64_t write_at(intptr_t file, const void* data, size_t size, uint64_t offset)
+{
+    return pwrite((int)file, data, size, (off_t)offset);
+}
+
+static void close_file(intptr_t file)
+{
+    ::close((int)file);
+}
+#endif
+
+bool RegionFile::read_generator(const string& path, uint32_t& generatorId)
+{
+    intptr_t file = open_file(path, false);
+    if(file == -1) return false;
+    uint32_t head[3];
+    bool ok = read_at(file, head, sizeof(head), 0) == (int64_t)sizeof(head) && head[0] == REGION_MAGIC;
+    close_file(file);
+    // 旧版本的头部没有生成器标识，按 0 处理
+    generatorId = ok && head[1] == REGION_VERSION ? head[2] : 0;
+    return ok;
+}
+
+bool RegionFile::open(const string& path, uint32_t generatorId)
+{
+    close();
+    fd = open_file(path, true);
+    if(fd == -1) return false;
+
+    uint32_t head[3];
+    int64_t got = read_at(fd, head, sizeof(head), 0);
+    if(got == 0)
+    {
+        // 新文件：写入空头部
+        head[0] = REGION_MAGIC;
+        head[1] = REGION_VERSION;
+        head[2] = generatorId;
+        vector<uint8_t> header(header_size(), 0);
+        memcpy(header.data(), head, sizeof(head));
+        if(write_at(fd, header.data(), header.size(), 0) != (int64_t)header.size())
+        {
+            close();
+            return false;
+        }
+        fileEnd = (uint32_t)((header_size() + REGION_SECTOR - 1) / REGION_SECTOR * REGION_SECTOR);
+        return true;
+    }
+
+    if(got != (int64_t)sizeof(head) || head[0] != REGION_MAGIC || head[1] != REGION_VERSION || head[2] != generatorId ||
+       read_at(fd, table, sizeof(table), tableOffset) != (int64_t)sizeof(table))
+    {
+        close();
+        return false;
+    }
+    fileEnd = (uint32_t)((header_size() + REGION_SECTOR - 1) / REGION_SECTOR * REGION_SECTOR);
+    for(const Entry& entry : table)
+        fileEnd = max(fileEnd, entry.offset + entry.capacity);
+    return true;
+}
+
+void RegionFile::close()
+{
+    if(fd != -1) close_file(fd);
+    fd = -1;
+    for(Entry& entry : table) entry = Entry();
+    for(Entry& entry : spare) entry = Entry();
+    fileEnd = 0;
+}
+
+bool RegionFile::has_chunk(int local) const
+{
+    lock_guard<mutex> lock(mtx);
+    return fd != -1 && table[local].size > 0;
+}
+
+bool RegionFile::read_chunk(int local, vector<uint8_t>& out) const
+{
+    // 持锁读取：主线程可能正在改写该区块的表项，并复用它腾出的空间
+    lock_guard<mutex> lock(mtx);
+    const Entry& entry = table[local];
+    if(fd == -1 || entry.size == 0) return false;
+    out.resize(entry.size);
+    return read_at(fd, out.data(), entry.size, entry.offset) == (int64_t)entry.size;
+}
+
+bool RegionFile::write_chunk(int local, const vector<uint8_t>& data)
+{
+    lock_guard<mutex> lock(mtx);
+    if(fd == -1 || data.empty()) return false;
+
+    // 不覆盖当前记录：优先写入上次腾出的空间，放不下时追加到文件末尾（腾出的空间不再复用）
+    Entry entry = spare[local];
+    if(data.size() > entry.capacity)
+    {
+        entry.offset = fileEnd;
+        entry.capacity = (uint32_t)((data.size() + REGION_SECTOR - 1) / REGION_SECTOR * REGION_SECTOR);
+    }
+    entry.size = (uint32_t)data.size();
+
+    if(write_at(fd, data.data(), data.size(), entry.offset) != (int64_t)data.size())
+        return false;
+    fileEnd = max(fileEnd, entry.offset + entry.capacity);
+    // 记录写完后再更新头部表项，中途失败时头部仍指向完整的旧记录
+    if(write_at(fd, &entry, sizeof(Entry), tableOffset + sizeof(Entry) * local) != (int64_t)sizeof(Entry))
+        return false;
+    // 旧记录不再被引用，成为下次重写的空间
+    spare[local] = table[local];
+    spare[local].size = 0;
+    table[local] = entry;
+    return true;
+}
+
+bool RegionStore::open(const string& dir, uint32_t generatorId)
+{
+    close();
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    if(ec) return false;
+
+    // 区域文件按需打开，这里先检查已有文件，避免新旧生成器的区块混在同一个世界里
+    for(const filesystem::directory_entry& file : filesystem::directory_iterator(dir, ec))
+    {
+        uint32_t fileGenerator;
+        if(file.path().extension() == ".mrg" &&
+           (!RegionFile::read_generator(file.path().string(), fileGenerator) || fileGenerator != generatorId))
+            return false;
+    }
+    if(ec) return false;
+    directory = dir;
+    generator = generatorId;
+    return true;
+}
+
+void RegionStore::close()
+{
+    lock_guard<mutex> lock(mtx);
+    regions.clear();
+    directory.clear();
+}
+
+RegionFile* RegionStore::region_of(const ChunkIndex& index, bool create, int& local)
+{
+    // 算术右移即向下取整，负坐标同样适用
+    pair<int, int> region(index.first >> REGION_SHIFT, index.second >> REGION_SHIFT);
+    local = (index.second & (REGION_SIZE - 1)) * REGION_SIZE + (index.first & (REGION_SIZE - 1));
+
+    lock_guard<mutex> lock(mtx);
+    if(directory.empty()) return nullptr;
+    auto it = regions.find(region);
+    if(it != regions.end())
+        return it->second.get();
+
+    string path = directory + "/r." + to_string(region.first) + "." + to_string(region.second) + ".mrg";
+    if(!create && !filesystem::exists(path))
+        return nullptr;
+    unique_ptr<RegionFile> file = make_unique<RegionFile>();
+    if(!file->open(path, generator))
+        return nullptr;
+    return (regions[region] = std::move(file)).get();
+}
+
+bool RegionStore::has_chunk(const ChunkIndex& index)
+{
+    int local;
+    RegionFile* file = region_of(index, false, local);
+    return file && file->has_chunk(local);
+}
+
+unique_ptr<Chunk> RegionStore::load_chunk(const ChunkIndex& index)
+{
+    int local;
+    RegionFile* file = region_of(index, false, local);
+    vector<uint8_t> data;
+    if(!file || !file->read_chunk(local, data) || data.size() < 5)
+        return nullptr;
+
+    uint8_t flags = data[0];
+    uint32_t blocksSize;
+    memcpy(&blocksSize, &data[1], sizeof(blocksSize));
+    if(blocksSize > data.size() - 5)
+        return nullptr;
+
+    unique_ptr<Chunk> chunk = make_unique<Chunk>();
+    if(!chunk->deserialize_blocks(&data[5], blocksSize))
+        return nullptr;
+    // 不含光照或光照损坏时保留 deserialize_blocks 设置的全量重算（天空光与发光方块的方块光，见 Terrain::advance_chunk）
+    if((flags & 1) && !chunk->deserialize_lights(&data[5] + blocksSize, data.size() - 5 - blocksSize))
+        chunk->mark_light_dirty(FULL_RESET);
+    chunk->persisted = true;
+    return chunk;
+}
+
+bool RegionStore::save_chunk(const ChunkIndex& index, Chunk& chunk)
+{
+    int local;
+    RegionFile* file = region_of(index, true, local);
+    if(!file) return false;
+
+    // 光照有待处理的增量更新时不写入，读取后重算
+    bool withLights = chunk.lightUpdate < FULL_RESET && !chunk.has_pending_lights();
+    vector<uint8_t> data(5);
+    data[0] = withLights ? 1 : 0;
+    chunk.serialize_blocks(data);
+    uint32_t blocksSize = (uint32_t)(data.size() - 5);
+    memcpy(&data[1], &blocksSize, sizeof(blocksSize));
+    if(withLights)
+        chunk.serialize_lights(data);
+
+    if(!file->write_chunk(local, data))
+        return false;
+    chunk.persisted = true;
+    chunk.modified = false;
+    return true;
+}
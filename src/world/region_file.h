@@ -0,0 +1,112 @@
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include "chunk.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define REGION_SHIFT 5                                  // 每个区域 2^5 × 2^5 个区块
+#define REGION_SIZE (1 << REGION_SHIFT)
+#define REGION_CHUNKS (REGION_SIZE * REGION_SIZE)
+#define REGION_MAGIC 0x4E47524Du                        // "MRGN"
+#define REGION_VERSION 2
+#define REGION_SECTOR 4096                              // 区块记录按扇区对齐分配
+#define WORLD_SAVE_DIR "./saves"                        // 存档根目录，每个种子一个子目录
+
+// 区域文件：一个文件保存 32×32 个区块
+//
+// 文件布局（小端）：
+//   头部    [magic u32][version u32][生成器标识 u32][REGION_CHUNKS × {offset u32, size u32, capacity u32}]
+//   记录区  各区块的记录，起点与容量按 REGION_SECTOR 对齐
+// 头部常驻内存，读取单个区块只需一次按偏移读取（pread / 带 OVERLAPPED 偏移的 ReadFile）。写入从不覆盖头部表项引用的记录：新记录写入另一块空间，
+// 写完后才改写该区块的头部表项，崩溃或写入不完整时旧记录仍然有效。每个区块在两块空间之间交替——
+// 上次重写腾出的旧空间（只记在内存中）能放下新记录时复用，否则追加到文件末尾。
+class RegionFile
+{
+    private:
+        struct Entry
+        {
+            uint32_t offset = 0;
+            uint32_t size = 0;                          // 0 表示区块不存在
+            uint32_t capacity = 0;
+        };
+
+        intptr_t fd = -1;                               // 文件描述符（Windows 下为 HANDLE），-1 表示未打开
+        Entry table[REGION_CHUNKS];
+        Entry spare[REGION_CHUNKS];                     // 各区块上次重写腾出的空间（不被头部引用，可直接覆盖）
+        uint32_t fileEnd = 0;
+        mutable std::mutex mtx;                         // 工作线程读取与主线程写入共用
+
+        static const size_t tableOffset = 12;              // 头部固定字段之后为区块表
+        static size_t header_size() { return tableOffset + sizeof(Entry) * REGION_CHUNKS; }
+
+    public:
+        RegionFile(){};
+
+        ~RegionFile()
+        {
+            close();
+        }
+
+        // 打开（不存在则创建）区域文件，头部损坏或生成器标识不同时返回 false
+        bool open(const std::string& path, uint32_t generatorId);
+
+        // 读取已有区域文件头部的生成器标识，不是区域文件时返回 false
+        static bool read_generator(const std::string& path, uint32_t& generatorId);
+        void close();
+
+        // local 为区域内区块下标 z * REGION_SIZE + x
+        bool has_chunk(int local) const;
+        bool read_chunk(int local, std::vector<uint8_t>& out) const;
+        bool write_chunk(int local, const std::vector<uint8_t>& data);
+
+        RegionFile(const RegionFile&) = delete;
+        RegionFile& operator=(const RegionFile&) = delete;
+};
+
+// 一个世界的全部区域文件（<dir>/r.<rx>.<rz>.mrg），按需打开
+//
+// 区块记录：[flags u8][方块数据长度 u32][Chunk::serialize_blocks][Chunk::serialize_lights]
+// flags 的最低位表示记录含光照；保存时光照尚未稳定（有待处理的增量更新）则不写光照，读取后全量重算。
+// 目录中的区域文件须由同一生成器标识写入（未保存的区块要重新生成，并与保存的区块相邻），否则拒绝打开存档。
+// load_chunk 可在生成线程上并发调用，save_chunk 在主线程调用。
+class RegionStore
+{
+    public:
+        typedef std::pair<int, int> ChunkIndex;
+
+    private:
+        std::string directory;
+        uint32_t generator = 0;
+        std::map<std::pair<int, int>, std::unique_ptr<RegionFile>> regions;
+        std::mutex mtx;                                 // 保护 regions
+
+        // 返回区块所在区域文件，create 为 false 且文件不存在时返回 nullptr
+        RegionFile* region_of(const ChunkIndex& index, bool create, int& local);
+
+    public:
+        RegionStore(){};
+
+        // 打开存档目录（不存在则创建），目录中有由其他生成器标识写入的区域文件时返回 false
+        bool open(const std::string& dir, uint32_t generatorId);
+        void close();
+        bool is_open() const { return !directory.empty(); }
+
+        bool has_chunk(const ChunkIndex& index);
+
+        // 读取区块，不存在或记录损坏时返回空
+        std::unique_ptr<Chunk> load_chunk(const ChunkIndex& index);
+
+        // 写入区块，成功后区块标记为已保存
+        bool save_chunk(const ChunkIndex& index, Chunk& chunk);
+
+        RegionStore(const RegionStore&) = delete;
+        RegionStore& operator=(const RegionStore&) = delete;
+};
+
+#endif
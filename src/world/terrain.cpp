@@ -1,13 +1,14 @@
 #include <glad/glad.h>
 #include "terrain.h"
 #include <algorithm>
+#include <chrono>
 
 using namespace std;
 
 // TODO: const glm::vec3 Chunk::terrainOffset[13][2] = {};
 
-// 视锥体剔除：从VP矩阵提取6个平面，测试chunk的AABB是否完全在视锥外
-bool Terrain::is_chunk_visible(const glm::mat4& vp, int cx, int cz) const
+// 视锥体剔除：从VP矩阵提取6个平面，测试AABB是否完全在视锥外
+bool Terrain::is_aabb_visible(const glm::mat4& vp, const glm::vec3& aabbMin, const glm::vec3& aabbMax)
 {
     // 从VP矩阵提取6个裁剪平面 (Gribb/Hartmann方法)
     // 平面方程: ax+by+cz+d >= 0 为可见侧
@@ -24,12 +25,6 @@ bool Terrain::is_chunk_visible(const glm::mat4& vp, int cx, int cz) const
     planes[4] = row3 + row2;  // Near
     planes[5] = row3 - row2;  // Far
 
-    // chunk的世界空间AABB
-    float minX = (float)(cx * CHUNK_SIZE - CHUNK_SIZE / 2);
-    float minZ = (float)(cz * CHUNK_SIZE - CHUNK_SIZE / 2);
-    glm::vec3 aabbMin(minX, 0.0f, minZ);
-    glm::vec3 aabbMax(minX + CHUNK_SIZE, (float)CHUNK_HEIGHT, minZ + CHUNK_SIZE);
-
     // 对每个平面，用P-vertex测试
     for(int i = 0; i < 6; i++)
     {
@@ -43,17 +38,36 @@ bool Terrain::is_chunk_visible(const glm::mat4& vp, int cx, int cz) const
     return true;
 }
 
+bool Terrain::is_chunk_visible(const glm::mat4& vp, int cx, int cz) const
+{
+    // chunk的世界空间原点
+    glm::vec3 origin((float)(cx * CHUNK_SIZE - CHUNK_SIZE / 2), 0.0f, (float)(cz * CHUNK_SIZE - CHUNK_SIZE / 2));
+
+    const Chunk* chunk = loadedChunks.find({cx, cz});
+    if(!chunk)
+    {
+        // 尚未加载：按整列测试
+        return is_aabb_visible(vp, origin, origin + glm::vec3(CHUNK_SIZE, CHUNK_HEIGHT, CHUNK_SIZE));
+    }
+
+    // 全空气分段没有几何，不参与测试
+    for(int s = 0; s < SECTION_NUM; s++)
+    {
+        if(chunk->is_section_empty(s)) continue;
+        const ChunkSection& section = chunk->sections[s];
+        if(is_aabb_visible(vp, origin + section.aabbMin, origin + section.aabbMax))
+            return true;
+    }
+    return false;
+}
+
 BLOCK_TYPE Terrain::get_block_type(const glm::vec3& position)
 {
     chunk_index_x = floor((float)(position.x+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     chunk_index_z = floor((float)(position.z+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
 
     pair<int, int> index(chunk_index_x, chunk_index_z);
-    if(terrainMap.find(index) == terrainMap.end())
-    {
-        terrainMap[index] = make_unique<Chunk>(perlinNoise, index.first, index.second);
-    }
-    return terrainMap[index]->get_block_type(position.x-chunk_index_x*CHUNK_SIZE+CHUNK_SIZE/2, position.z-chunk_index_z*CHUNK_SIZE+CHUNK_SIZE/2, position.y);
+    return get_or_create_chunk(index)->get_block_type(position.x-chunk_index_x*CHUNK_SIZE+CHUNK_SIZE/2, position.z-chunk_index_z*CHUNK_SIZE+CHUNK_SIZE/2, position.y);
 }
 
 int Terrain::get_height(const glm::vec3& position)
@@ -61,87 +75,156 @@ int Terrain::get_height(const glm::vec3& position)
     chunk_index_x = floor((float)(position.x+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     chunk_index_z = floor((float)(position.z+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     pair<int, int> index(chunk_index_x, chunk_index_z);
-    if(terrainMap.find(index) == terrainMap.end())
-    {
-        terrainMap[index] = make_unique<Chunk>(perlinNoise, index.first, index.second);
-    }
-    return terrainMap[index]->get_height(position.x-chunk_index_x*CHUNK_SIZE+CHUNK_SIZE/2, position.z-chunk_index_z*CHUNK_SIZE+CHUNK_SIZE/2);
+    return get_or_create_chunk(index)->get_height(position.x-chunk_index_x*CHUNK_SIZE+CHUNK_SIZE/2, position.z-chunk_index_z*CHUNK_SIZE+CHUNK_SIZE/2);
+}
+
+void Terrain::init_draw_buffers()
+{
+    glGenBuffers(1, &indirectBuffer);
+    glGenBuffers(1, &originBuffer);
+
+    // 区块原点为逐实例属性：每条绘制只有 1 个实例，baseInstance 即原点下标
+    glBindVertexArray(vertexArena.vao());
+    glBindBuffer(GL_ARRAY_BUFFER, originBuffer);
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glVertexAttribDivisor(5, 1);
+    glBindVertexArray(0);
 }
 
 void Terrain::draw_terrain(Shader& blockShader, const glm::mat4& vpMatrix, const glm::vec3& cameraPos)
 {
     blockShader.set_int("textureUsed", 0);
+    glm::mat4 model = glm::mat4(1.0f);
+    blockShader.set_mat4("model", model);   // 区块原点由逐实例属性给出
     unsigned int totalIndices = 0;
 
-    // Pass 1: 不透明方块（深度写入ON，混合OFF）
-    for(int i = -2; i <= 2; i++)
+    drawCommands.clear();
+    drawOrigins.clear();
+
+    // 渲染范围以加载窗口中心为准（方块查询会改写 chunk_index_x/z）
+    int centerX = loadedChunks.center_x(), centerZ = loadedChunks.center_z();
+
+    // Pass 1: 不透明方块，逐分段剔除后生成间接绘制命令
+    for(int i = -renderDistance; i <= renderDistance; i++)
     {
-        for(int j = -2; j <= 2; j++)
+        for(int j = -renderDistance; j <= renderDistance; j++)
         {
-            pair<int, int> index(chunk_index_x+i, chunk_index_z+j);
-            if(!is_chunk_visible(vpMatrix, index.first, index.second))
+            pair<int, int> index(centerX+i, centerZ+j);
+            Chunk* chunk = loadedChunks.find(index);
+            const ChunkRenderData* data = find_render_data(index);
+            if(!chunk || !data || !is_chunk_visible(vpMatrix, index.first, index.second))
                 continue;
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(index.first*CHUNK_SIZE-CHUNK_SIZE/2, 0.0f, index.second*CHUNK_SIZE-CHUNK_SIZE/2));
-            blockShader.set_mat4("model", model);
-            unsigned int indexCount = static_cast<unsigned int>(terrainMap[index]->indices.size());
-            totalIndices += indexCount;
-            glBindVertexArray(terrainMap[index]->VAO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainMap[index]->EBO);
-            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+            glm::vec3 chunkOrigin(index.first*CHUNK_SIZE-CHUNK_SIZE/2, 0.0f, index.second*CHUNK_SIZE-CHUNK_SIZE/2);
+            for(int s = 0; s < SECTION_NUM; s++)
+            {
+                const ChunkSection& section = chunk->sections[s];
+                const SectionRenderData& gpu = data->sections[s];
+                if(gpu.opaqueRange.empty())
+                    continue;
+                if(!is_aabb_visible(vpMatrix, chunkOrigin + section.aabbMin, chunkOrigin + section.aabbMax))
+                    continue;
+                unsigned int indexCount = section.index_count();
+                totalIndices += indexCount;
+                // 索引来自共享四边形索引缓冲，firstIndex 恒为 0
+                drawCommands.push_back({indexCount, 1, 0, (GLint)gpu.opaqueRange.offset, (GLuint)drawOrigins.size()});
+                drawOrigins.push_back(chunkOrigin);
+            }
         }
     }
 
-    // Pass 2: 透明方块（深度写入OFF，混合ON，按距离从远到近排序）
-    struct TransparentChunk {
+    // Pass 2: 透明方块（深度写入OFF，混合ON，按分段中心距离从远到近排序）
+    struct TransparentSection {
         pair<int, int> index;
+        int section;
         float distSq;
     };
-    vector<TransparentChunk> transparentChunks;
+    vector<TransparentSection> transparentSections;
 
-    for(int i = -2; i <= 2; i++)
+    for(int i = -renderDistance; i <= renderDistance; i++)
     {
-        for(int j = -2; j <= 2; j++)
+        for(int j = -renderDistance; j <= renderDistance; j++)
         {
-            pair<int, int> index(chunk_index_x+i, chunk_index_z+j);
-            if(!is_chunk_visible(vpMatrix, index.first, index.second))
+            pair<int, int> index(centerX+i, centerZ+j);
+            Chunk* chunk = loadedChunks.find(index);
+            const ChunkRenderData* data = find_render_data(index);
+            if(!chunk || !data || !is_chunk_visible(vpMatrix, index.first, index.second))
                 continue;
-            if(terrainMap[index]->indicesT.empty())
-                continue;
-            float cx = (float)(index.first * CHUNK_SIZE);
-            float cz = (float)(index.second * CHUNK_SIZE);
-            float dx = cx - cameraPos.x;
-            float dz = cz - cameraPos.z;
-            transparentChunks.push_back({index, dx*dx + dz*dz});
+            glm::vec3 chunkOrigin(index.first*CHUNK_SIZE-CHUNK_SIZE/2, 0.0f, index.second*CHUNK_SIZE-CHUNK_SIZE/2);
+            for(int s = 0; s < SECTION_NUM; s++)
+            {
+                const ChunkSection& section = chunk->sections[s];
+                if(data->sections[s].transparentRange.empty())
+                    continue;
+                glm::vec3 aabbMin = chunkOrigin + section.aabbMin;
+                glm::vec3 aabbMax = chunkOrigin + section.aabbMax;
+                if(!is_aabb_visible(vpMatrix, aabbMin, aabbMax))
+                    continue;
+                glm::vec3 d = (aabbMin + aabbMax) * 0.5f - cameraPos;
+                transparentSections.push_back({index, s, glm::dot(d, d)});
+            }
         }
     }
 
-    sort(transparentChunks.begin(), transparentChunks.end(),
-        [](const TransparentChunk& a, const TransparentChunk& b) { return a.distSq > b.distSq; });
+    sort(transparentSections.begin(), transparentSections.end(),
+        [](const TransparentSection& a, const TransparentSection& b) { return a.distSq > b.distSq; });
+
+    // 透明分段的原点接在不透明命令之后，一次性上传
+    GLuint transparentBaseInstance = (GLuint)drawOrigins.size();
+    for(auto& ts : transparentSections)
+        drawOrigins.push_back(glm::vec3(ts.index.first*CHUNK_SIZE-CHUNK_SIZE/2, 0.0f, ts.index.second*CHUNK_SIZE-CHUNK_SIZE/2));
+
+    if(drawOrigins.empty())
+    {
+        vertexArena.end_frame();
+        drawnTriangles = drawnVertices = 0;
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, originBuffer);
+    glBufferData(GL_ARRAY_BUFFER, drawOrigins.size() * sizeof(glm::vec3), drawOrigins.data(), GL_STREAM_DRAW);
+
+    // 所有分段共用显存池的 VAO，以 baseVertex 定位各自的顶点区间
+    glBindVertexArray(vertexArena.vao());
+
+    // 不透明分段：一次 glMultiDrawElementsIndirect 提交，CPU 开销与可见分段数无关
+    if(!drawCommands.empty())
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, drawCommands.size() * sizeof(DrawElementsIndirectCommand), drawCommands.data(), GL_STREAM_DRAW);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)drawCommands.size(), 0);
+    }
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glDepthMask(GL_FALSE);
 
-    for(auto& tc : transparentChunks)
+    // 透明分段：每帧重排索引，各自绑定透明 EBO 逐个绘制
+    for(size_t t = 0; t < transparentSections.size(); t++)
     {
-        glm::vec3 chunkOrigin(tc.index.first*CHUNK_SIZE-CHUNK_SIZE/2, 0.0f, tc.index.second*CHUNK_SIZE-CHUNK_SIZE/2);
+        const TransparentSection& ts = transparentSections[t];
+        Chunk* chunk = loadedChunks.find(ts.index);
+        ChunkSection& section = chunk->sections[ts.section];
+        SectionRenderData& gpu = renderData.at(ts.index).sections[ts.section];
         // 将摄像机变换到chunk局部空间，排序透明面片（远→近）
-        terrainMap[tc.index]->sort_transparent_faces(cameraPos - chunkOrigin);
+        if(section.sort_transparent_faces(cameraPos - drawOrigins[transparentBaseInstance + t]))
+            gpu.upload_transparent_indices(section);
 
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, chunkOrigin);
-        blockShader.set_mat4("model", model);
-        unsigned int indexCount = static_cast<unsigned int>(terrainMap[tc.index]->indicesT.size());
+        unsigned int indexCount = static_cast<unsigned int>(section.indicesT.size());
         totalIndices += indexCount;
-        glBindVertexArray(terrainMap[tc.index]->transparentVAO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainMap[tc.index]->transparentEBO);
-        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpu.transparentEBO);
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (void*)0, 1,
+            (GLint)gpu.transparentRange.offset, transparentBaseInstance + (GLuint)t);
     }
 
     glDepthMask(GL_TRUE);
     glDisable(GL_BLEND);
 
+    // 恢复共享 VAO 的四边形索引缓冲；本帧释放的显存区间在此之后插入 fence
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ChunkRenderData::quad_index_buffer());
+    glBindVertexArray(0);
+    vertexArena.end_frame();
+
     // 每个面 = 4顶点 + 6索引
     drawnTriangles = totalIndices / 3;
     drawnVertices = totalIndices / 6 * 4;
@@ -152,100 +235,413 @@ void Terrain::update_terrain(const glm::vec3& position, const glm::mat4* vpMatri
 {
     chunk_index_x = floor((float)(position.x+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     chunk_index_z = floor((float)(position.z+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
+    bool windowChanged = update_window(chunk_index_x, chunk_index_z);
 
-    // === Pass 1: 内部光照更新（无需邻居数据） ===
-    // 先处理所有区块的内部光照（pending BFS / FULL_RESET / boundary removal），
-    // 确保各区块边界格光照正确后，再进行跨区块传播和 mesh 构建。
-    // 这避免了遍历顺序导致邻居读到未更新的边界光照的问题。
-    for(int i = -2; i <= 2; i++)
+    // === Pass 0: 并入后台生成完成的区块；窗口变化后为缺失区块提交生成任务 ===
+    // 缓存只在窗口移动或有区块并入时变化，其余帧不检查预算
+    bool integrated = integrate_generated_chunks();
+    if(windowChanged)
+        request_missing_chunks();
+    if(windowChanged || integrated)
+        enforce_memory_budget();
+
+    // === Pass 1: 推进状态可能变化的区块（内部光照 → 邻居光照 → mesh 构建），不轮询整个渲染范围 ===
+    // 摄像机不动时 hidden 区块的可见性不会变化
+    if(vpMatrix && scheduler.hidden_count() > 0 && *vpMatrix != revealMatrix)
     {
-        for(int j = -2; j <= 2; j++)
+        revealMatrix = *vpMatrix;
+        scheduler.reveal([&](const pair<int, int>& index) { return is_chunk_visible(*vpMatrix, index.first, index.second); });
+    }
+    if(scheduler.ready_count() > 0)
+        advance_chunks(vpMatrix);
+
+    // === Pass 2: 上传后台构建完成的 mesh ===
+    if(!meshingChunks.empty())
+        upload_meshes(MESH_UPLOAD_BUDGET);
+}
+
+void Terrain::request_missing_chunks()
+{
+    // 渲染范围外再多请求一圈，作为边缘区块构建 mesh 时所需的邻居；
+    // 按到摄像机所在区块的距离排优先级，离开范围的任务取消
+    // 缓存或溢出文件中已有的区块直接取回，不再重新生成
+    const int loadRadius = renderDistance + 1;
+    int cx = loadedChunks.center_x(), cz = loadedChunks.center_z();
+    generator.cancel_outside(cx, cz, loadRadius);
+    for(int i = -loadRadius; i <= loadRadius; i++)
+    {
+        for(int j = -loadRadius; j <= loadRadius; j++)
         {
-            pair<int, int> index(chunk_index_x+i, chunk_index_z+j);
-            if(terrainMap.find(index) == terrainMap.end())
-                terrainMap[index] = make_unique<Chunk>(perlinNoise, index.first, index.second);
+            pair<int, int> index(cx+i, cz+j);
+            if(loadedChunks.find(index) || reload_chunk(index))
+                continue;
+            generator.request(index, i*i + j*j);
+            scheduler.mark_requested(index);
+        }
+    }
+}
 
-            if(terrainMap[index]->lightUpdate >= FULL_RESET)
-            {
-                terrainMap[index]->init_local_light();
-                terrainMap[index]->clear_pending_lights();
-            }
-            else if(terrainMap[index]->has_pending_lights())
+void Terrain::advance_chunks(const glm::mat4* vpMatrix)
+{
+    // 推进过程中被唤醒或重新标记的区块进入下一批，直到队列清空或用完时间预算。
+    // 预算对整次调用计算（不是每一批）：每帧至少推进一个区块，之后每个区块之前都检查用时
+    auto start = chrono::steady_clock::now();
+    int cx = loadedChunks.center_x(), cz = loadedChunks.center_z();
+    int advanced = 0;
+    vector<pair<int, int>> batch;
+    vector<pair<int, pair<int, int>>> order;
+    while(scheduler.take_ready(batch))
+    {
+        // 视野外的区块排在所有视野内区块之后，同类按到中心区块的距离排序
+        order.clear();
+        for(const pair<int, int>& index : batch)
+        {
+            int di = index.first - cx, dj = index.second - cz;
+            bool visible = !vpMatrix || is_chunk_visible(*vpMatrix, index.first, index.second);
+            order.push_back({(visible ? 0 : 1 << 24) + di*di + dj*dj, index});
+        }
+        sort(order.begin(), order.end());
+
+        for(size_t n = 0; n < order.size(); n++)
+        {
+            double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            if(elapsed > CHUNK_ADVANCE_BUDGET_MS && advanced > 0)
             {
-                terrainMap[index]->process_pending_lights();
+                // 剩余的区块留到下一帧
+                for(; n < order.size(); n++)
+                    scheduler.notify(order[n].second);
+                return;
             }
+            advance_chunk(order[n].second, vpMatrix);
+            advanced++;
         }
     }
+}
+
+void Terrain::advance_chunk(const pair<int, int>& index, const glm::mat4* vpMatrix)
+{
+    Chunk* chunk = loadedChunks.find(index);
+    if(!chunk)
+        return;     // 已移出窗口或尚未载入（载入时会再次通知）
+    // 上一次的 mesh 仍在构建或等待上传：上传后再次通知，避免新旧结果乱序覆盖
+    if(meshingChunks.count(index))
+        return;
 
-    // === Pass 2: 跨区块光照传播 + 几何更新 ===
-    for(int i = -2; i <= 2; i++)
+    // === Generated → LocallyLit：只需本区块；外围一圈的区块也要完成，邻居读取的边界光照才正确 ===
+    if(chunk->stage < STAGE_LIT)
     {
-        for(int j = -2; j <= 2; j++)
+        if(chunk->lightUpdate >= FULL_RESET)
         {
-            pair<int, int> index(chunk_index_x+i, chunk_index_z+j);
-            if(terrainMap[index]->meshUpdate > MESH_NONE || terrainMap[index]->lightUpdate > NONE)
-            {
-                // === 加载四个邻居区块（只做一次） ===
-                for(int x = -1; x <= 1; x += 2)
-                {
-                    pair<int, int> adjIndex(index.first+x, index.second);
-                    if(terrainMap.find(adjIndex) == terrainMap.end())
-                        terrainMap[adjIndex] = make_unique<Chunk>(perlinNoise, adjIndex.first, adjIndex.second);
-                }
-                for(int y = -1; y <= 1; y += 2)
-                {
-                    pair<int, int> adjIndex(index.first, index.second+y);
-                    if(terrainMap.find(adjIndex) == terrainMap.end())
-                        terrainMap[adjIndex] = make_unique<Chunk>(perlinNoise, adjIndex.first, adjIndex.second);
-                }
-                pair<int, int> left(index.first-1, index.second);
-                pair<int, int> right(index.first+1, index.second);
-                pair<int, int> forward(index.first, index.second-1);
-                pair<int, int> back(index.first, index.second+1);
-                const Chunk* neighbours[4] = {
-                    terrainMap[left].get(),
-                    terrainMap[right].get(),
-                    terrainMap[forward].get(),
-                    terrainMap[back].get()
-                };
-
-                // 跨区块边界光照传播（此时所有区块内部光照已在 Pass 1 中更新）
-                bool lightChanged = (terrainMap[index]->lightUpdate > NONE);
-                if(terrainMap[index]->lightUpdate >= PROPAGATE)
-                    terrainMap[index]->update_chunk_light(neighbours);
-                terrainMap[index]->lightUpdate = NONE;
-
-                // === 几何更新（不可见时保留 meshUpdate 延迟处理） ===
-                bool visible = !vpMatrix || is_chunk_visible(*vpMatrix, index.first, index.second);
-
-                if(terrainMap[index]->meshUpdate >= MESH_FULL_REBUILD)
-                {
-                    if(visible)
-                        terrainMap[index]->update_data(neighbours);
-                    // else: meshUpdate 保留，进入视野后再构建
-                }
-                else if(terrainMap[index]->meshUpdate >= MESH_BORDER_REFRESH)
-                {
-                    if(visible)
-                    {
-                        terrainMap[index]->refresh_border_mesh(neighbours);
-                        if(lightChanged)
-                            terrainMap[index]->refresh_vertex_lights(neighbours);
-                    }
-                    else if(lightChanged)
-                    {
-                        // 光照已处理但 mesh 不可见，标记下帧继续刷新顶点
-                        terrainMap[index]->lightUpdate = VERTEX_ONLY;
-                    }
-                }
-                else if(lightChanged)
-                {
-                    // 仅光照变化，刷新顶点光照
-                    terrainMap[index]->refresh_vertex_lights(neighbours);
-                }
-            }
+            // 只读回了方块（溢出记录或不含光照的存档）：天空光与发光方块的方块光都要重算
+            chunk->init_local_light();
+            chunk->init_torch_light();
+            chunk->clear_pending_lights();
+        }
+        else if(chunk->has_pending_lights())
+        {
+            chunk->process_pending_lights();
         }
+        chunk->stage = STAGE_LIT;
+        scheduler.wake(index);
     }
+    if(!in_render_area(index))
+        return;
+
+    // === 四个邻居区块须已载入并完成内部光照，否则等待邻居就绪 ===
+    pair<int, int> neighbourIndex[4] = {
+        {index.first-1, index.second}, {index.first+1, index.second},
+        {index.first, index.second-1}, {index.first, index.second+1}
+    };
+    const Chunk* neighbours[4];
+    bool neighboursReady = true;
+    for(int n = 0; n < 4; n++)
+    {
+        neighbours[n] = loadedChunks.find(neighbourIndex[n]);
+        if(!neighbours[n] || neighbours[n]->stage < STAGE_LIT)
+        {
+            scheduler.wait_for(neighbourIndex[n], index);
+            neighboursReady = false;
+        }
+    }
+    if(!neighboursReady)
+        return;
+
+    // === LocallyLit → NeighbourLit：跨区块边界光照传播，光照变化的顶点留到下面刷新 ===
+    if(chunk->stage == STAGE_LIT)
+    {
+        if(chunk->lightUpdate >= PROPAGATE)
+            chunk->update_chunk_light(neighbours);
+        chunk->lightUpdate = chunk->lightUpdate > NONE ? VERTEX_ONLY : NONE;
+        chunk->stage = STAGE_NEIGHBOUR_LIT;
+    }
+    if(chunk->stage != STAGE_NEIGHBOUR_LIT)
+        return;
+
+    // === NeighbourLit → Meshed：几何更新提交后台构建（不可见时等待进入视野） ===
+    bool lightChanged = (chunk->lightUpdate > NONE);
+    bool visible = !vpMatrix || is_chunk_visible(*vpMatrix, index.first, index.second);
+    int di = index.first - loadedChunks.center_x(), dj = index.second - loadedChunks.center_z();
+
+    if(chunk->meshUpdate >= MESH_FULL_REBUILD)
+    {
+        if(!visible)
+        {
+            scheduler.hide(index);
+            return;
+        }
+        chunk->lightUpdate = NONE;      // 完整重建使用最新光照
+        submit_mesh_job(index, neighbours, di*di + dj*dj);
+    }
+    else if(chunk->meshUpdate >= MESH_BORDER_REFRESH)
+    {
+        if(!visible)
+        {
+            scheduler.hide(index);
+            return;
+        }
+        // 内部面片的光照立即刷新，边界面片由后台重建（快照已包含新光照）
+        if(lightChanged)
+            upload_render_data(index, *chunk, chunk->refresh_vertex_lights(neighbours));
+        chunk->lightUpdate = NONE;
+        submit_mesh_job(index, neighbours, di*di + dj*dj);
+    }
+    else
+    {
+        // 仅光照变化，刷新顶点光照；几何没有变化，直接视为已上传
+        // （合并面片的光照不再一致时会标记完整重建，区块随之重新排队）
+        if(lightChanged)
+            upload_render_data(index, *chunk, chunk->refresh_vertex_lights(neighbours));
+        chunk->lightUpdate = NONE;
+        if(chunk->meshUpdate == MESH_NONE)
+            chunk->stage = STAGE_UPLOADED;
+    }
+}
+
+bool Terrain::update_window(int cx, int cz)
+{
+    int oldX = loadedChunks.center_x(), oldZ = loadedChunks.center_z();
+    int oldRadius = loadedChunks.get_radius();
+    ChunkGrid::ChunkList evicted;
+    if(oldRadius != renderDistance + 1)
+        loadedChunks.reset(renderDistance + 1, cx, cz, evicted);
+    else if(cx != oldX || cz != oldZ)
+        loadedChunks.recenter(cx, cz, evicted);
+    else
+        return false;
+
+    // 移出窗口的区块连同 mesh 放入缓存，是否释放由 enforce_memory_budget 按预算决定
+    for(auto& e : evicted)
+    {
+        e.second->attach_scheduler(nullptr, e.first);
+        chunkCache.put(e.first, std::move(e.second));
+    }
+    scheduler.retain([&](const pair<int, int>& index) { return loadedChunks.contains(index); });
+
+    // 新进入渲染范围的已加载区块（原来在外围一圈或渲染距离变化）需要继续推进
+    int oldRenderDistance = oldRadius - 1;
+    for(int i = -renderDistance; i <= renderDistance; i++)
+    {
+        for(int j = -renderDistance; j <= renderDistance; j++)
+        {
+            if(oldRenderDistance >= 0 && oldRadius == renderDistance + 1 &&
+               abs(cx+i - oldX) <= oldRenderDistance && abs(cz+j - oldZ) <= oldRenderDistance)
+                continue;
+            if(loadedChunks.find({cx+i, cz+j}))
+                scheduler.notify({cx+i, cz+j});
+        }
+    }
+    return true;
+}
+
+void Terrain::enforce_memory_budget()
+{
+    // 滞回带：窗口外 UNLOAD_HYSTERESIS 圈内的区块即使超出预算也保留，避免在边界来回移动时反复卸载与重建
+    int keepRadius = renderDistance + 1 + UNLOAD_HYSTERESIS;
+    int cx = loadedChunks.center_x(), cz = loadedChunks.center_z();
+
+    // 显存池的已用量要等 fence 回收后才下降，这里按本次归还的顶点数估算
+    size_t used = vertex_memory_used();
+    while(used > vramBudget)
+    {
+        auto release = [this](const pair<int, int>& index) { return release_render_data(index); };
+        unsigned int released = chunkCache.release_lru_mesh(cx, cz, keepRadius, release);
+        if(released == 0) break;
+        used -= min(used, (size_t)released * sizeof(TerrainVertex));
+    }
+
+    while(chunkCache.memory_usage() > cacheRamBudget)
+    {
+        auto persist = [this](const pair<int, int>& index, Chunk& chunk)
+        {
+            if(!persist_chunk(index, chunk))
+                return false;
+            release_render_data(index);
+            return true;
+        };
+        if(!chunkCache.drop_lru(cx, cz, keepRadius, persist)) break;
+    }
+}
+
+void Terrain::upload_render_data(const pair<int, int>& index, const Chunk& chunk, unsigned int sectionMask)
+{
+    if(sectionMask != 0)
+        renderData[index].upload(chunk, sectionMask, vertexArena);
+}
+
+unsigned int Terrain::release_render_data(const pair<int, int>& index)
+{
+    auto it = renderData.find(index);
+    if(it == renderData.end()) return 0;
+    unsigned int released = it->second.vertex_count();
+    it->second.release(vertexArena);
+    renderData.erase(it);
+    return released;
+}
+
+bool Terrain::reload_chunk(const pair<int, int>& index)
+{
+    unique_ptr<Chunk> chunk = chunkCache.take(index);
+    if(!chunk)
+        chunk = chunkCache.restore(index);
+    if(!chunk)
+        return false;
+
+    // 离开期间邻居可能已被重新生成，重新与邻居交换边界光照（保留的 mesh 随之刷新顶点光照）
+    chunk->mark_light_dirty(PROPAGATE);
+    adopt_chunk(index, std::move(chunk));
+    return true;
+}
+
+Chunk* Terrain::adopt_chunk(const pair<int, int>& index, unique_ptr<Chunk> chunk)
+{
+    chunk->attach_scheduler(&scheduler, index);
+    Chunk* adopted = loadedChunks.put(index, std::move(chunk));
+    scheduler.mark_loaded(index);
+    return adopted;
+}
+
+void Terrain::count_chunk_stages(size_t counts[STAGE_COUNT]) const
+{
+    std::fill(counts, counts + STAGE_COUNT, 0);
+    loadedChunks.for_each([&](const pair<int, int>&, Chunk& chunk) { counts[chunk.stage]++; });
+    counts[STAGE_NONE] = scheduler.requested_count();
+}
+
+size_t Terrain::chunk_memory_usage() const
+{
+    size_t bytes = 0;
+    loadedChunks.for_each([&](const pair<int, int>&, Chunk& chunk) { bytes += chunk.memory_usage(); });
+    return bytes + chunkCache.memory_usage();
+}
+
+bool Terrain::persist_chunk(const pair<int, int>& index, Chunk& chunk)
+{
+    // 增量存档只记录编辑，未编辑的区块可由种子重新生成
+    if(deltaStore.is_open())
+    {
+        if(chunk.modified)
+            deltaStore.record(index, chunk);
+        return true;
+    }
+    if(regionStore.is_open())
+        return !chunk.needs_save() || regionStore.save_chunk(index, chunk);
+    return !chunk.modified || chunkCache.spill(index, chunk);
+}
+
+void Terrain::save_all()
+{
+    if(!regionStore.is_open() && !deltaStore.is_open()) return;
+    auto save = [&](const pair<int, int>& index, Chunk& chunk) { persist_chunk(index, chunk); };
+    loadedChunks.for_each(save);
+    chunkCache.for_each(save);
+    deltaStore.flush();
+}
+
+void Terrain::submit_mesh_job(const pair<int, int>& index, const Chunk* neighbours[4], int priority)
+{
+    unique_ptr<ChunkMeshInput> input = make_unique<ChunkMeshInput>();
+    input->index = index;
+    input->greedy = greedyMeshing;
+    loadedChunks.find(index)->make_mesh_input(neighbours, *input);
+    meshingChunks.insert(index);
+    mesher.submit(std::move(input), priority);
+}
+
+void Terrain::upload_meshes(size_t byteBudget)
+{
+    vector<ChunkMeshResult> results;
+    mesher.collect(results);
+    for(ChunkMeshResult& result : results)
+    {
+        // 构建期间没有再被标记更新的区块进入 Meshed，等待上传
+        Chunk* chunk = loadedChunks.find(result.index);
+        if(chunk && chunk->stage == STAGE_NEIGHBOUR_LIT && chunk->meshUpdate == MESH_NONE && chunk->lightUpdate == NONE)
+            chunk->stage = STAGE_MESHED;
+        uploadQueue.push_back(std::move(result));
+    }
+
+    // 每帧至少上传一个结果，保证单个区块超出预算时也能推进
+    size_t uploaded = 0;
+    while(!uploadQueue.empty())
+    {
+        ChunkMeshResult& result = uploadQueue.front();
+        size_t bytes = result.byte_size();
+        if(uploaded > 0 && uploaded + bytes > byteBudget)
+            break;
+
+        // 构建期间区块可能已移出窗口，缓存中的区块照常应用；已被淘汰的结果作废（重新进入时完整重建）
+        Chunk* chunk = loadedChunks.find(result.index);
+        if(!chunk)
+            chunk = chunkCache.peek(result.index);
+        if(chunk)
+            upload_render_data(result.index, *chunk, chunk->apply_mesh(result));
+        meshingChunks.erase(result.index);
+        scheduler.notify(result.index);     // 构建期间的更新推迟到这里处理
+        uploaded += bytes;
+        uploadQueue.pop_front();
+    }
+}
+
+bool Terrain::integrate_generated_chunks()
+{
+    vector<pair<pair<int, int>, unique_ptr<Chunk>>> generated;
+    generator.collect(generated);
+    for(auto& g : generated)
+    {
+        // 同步路径可能已抢先生成同一区块，保留已有的（可能已被编辑）
+        if(loadedChunks.contains(g.first) && !loadedChunks.find(g.first))
+            adopt_chunk(g.first, std::move(g.second));
+    }
+    return !generated.empty();
+}
+
+Chunk* Terrain::find_chunk(const pair<int, int>& index)
+{
+    Chunk* chunk = loadedChunks.find(index);
+    return chunk ? chunk : chunkCache.find(index);
+}
+
+Chunk* Terrain::get_or_create_chunk(const pair<int, int>& index)
+{
+    Chunk* chunk = find_chunk(index);
+    if(chunk)
+        return chunk;
+
+    integrate_generated_chunks();
+    chunk = find_chunk(index);
+    if(chunk)
+        return chunk;
+
+    // 后台尚未完成：在当前线程同步生成（初始化出生点或越过加载范围时才会发生），流水线中已完成的阶段直接复用
+    // 溢出文件或存档中已有的区块直接读回；窗口外的区块放入缓存，由预算决定何时释放
+    unique_ptr<Chunk> created = chunkCache.restore(index);
+    if(!created && regionStore.is_open())
+        created = regionStore.load_chunk(index);
+    if(!created)
+        created = generator.generate_now(index);
+    if(loadedChunks.contains(index))
+        return adopt_chunk(index, std::move(created));
+    return chunkCache.put(index, std::move(created));
 }
 
 bool Terrain::destroy_block(glm::ivec3& selectedBlock)
@@ -253,26 +649,18 @@ bool Terrain::destroy_block(glm::ivec3& selectedBlock)
     chunk_index_x = floor((float)(selectedBlock.x+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     chunk_index_z = floor((float)(selectedBlock.z+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     pair<int, int> index(chunk_index_x, chunk_index_z);
-    if(terrainMap.find(index) == terrainMap.end())
-        terrainMap[index] = make_unique<Chunk>(perlinNoise, index.first, index.second);
+    Chunk* chunk = get_or_create_chunk(index);
 
     // 确保四个邻居已加载，构建 neighbours 数组
-    pair<int, int> left(index.first-1, index.second);
-    pair<int, int> right(index.first+1, index.second);
-    pair<int, int> forward(index.first, index.second-1);
-    pair<int, int> back(index.first, index.second+1);
-    pair<int, int> adj[4] = {left, right, forward, back};
-    for(auto& a : adj)
-    {
-        if(terrainMap.find(a) == terrainMap.end())
-            terrainMap[a] = make_unique<Chunk>(perlinNoise, a.first, a.second);
-    }
     Chunk* neighbours[4] = {
-        terrainMap[left].get(), terrainMap[right].get(),
-        terrainMap[forward].get(), terrainMap[back].get()
+        get_or_create_chunk({index.first-1, index.second}),
+        get_or_create_chunk({index.first+1, index.second}),
+        get_or_create_chunk({index.first, index.second-1}),
+        get_or_create_chunk({index.first, index.second+1})
     };
 
-    return terrainMap[index]->set_block(
+    // 本区块与邻居标记更新时自行通知调度器
+    return chunk->set_block(
         selectedBlock.x - chunk_index_x*CHUNK_SIZE + CHUNK_SIZE/2,
         selectedBlock.z - chunk_index_z*CHUNK_SIZE + CHUNK_SIZE/2,
         selectedBlock.y, AIR, neighbours);
@@ -283,25 +671,17 @@ bool Terrain::create_block(glm::ivec3& selectedBlock, BLOCK_TYPE blockType)
     chunk_index_x = floor((float)(selectedBlock.x+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     chunk_index_z = floor((float)(selectedBlock.z+CHUNK_SIZE/2) / (float)CHUNK_SIZE);
     pair<int, int> index(chunk_index_x, chunk_index_z);
-    if(terrainMap.find(index) == terrainMap.end())
-        terrainMap[index] = make_unique<Chunk>(perlinNoise, index.first, index.second);
-
-    pair<int, int> left(index.first-1, index.second);
-    pair<int, int> right(index.first+1, index.second);
-    pair<int, int> forward(index.first, index.second-1);
-    pair<int, int> back(index.first, index.second+1);
-    pair<int, int> adj[4] = {left, right, forward, back};
-    for(auto& a : adj)
-    {
-        if(terrainMap.find(a) == terrainMap.end())
-            terrainMap[a] = make_unique<Chunk>(perlinNoise, a.first, a.second);
-    }
+    Chunk* chunk = get_or_create_chunk(index);
+
     Chunk* neighbours[4] = {
-        terrainMap[left].get(), terrainMap[right].get(),
-        terrainMap[forward].get(), terrainMap[back].get()
+        get_or_create_chunk({index.first-1, index.second}),
+        get_or_create_chunk({index.first+1, index.second}),
+        get_or_create_chunk({index.first, index.second-1}),
+        get_or_create_chunk({index.first, index.second+1})
     };
 
-    return terrainMap[index]->set_block(
+    // 本区块与邻居标记更新时自行通知调度器
+    return chunk->set_block(
         selectedBlock.x - chunk_index_x*CHUNK_SIZE + CHUNK_SIZE/2,
         selectedBlock.z - chunk_index_z*CHUNK_SIZE + CHUNK_SIZE/2,
         selectedBlock.y, blockType, neighbours);
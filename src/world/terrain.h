@@ -2,40 +2,186 @@
 #define TERRAIN_H
 
 #include "chunk.h"
+#include "chunk_grid.h"
+#include "chunk_cache.h"
+#include "climate_cache.h"
+#include "chunk_generator.h"
+#include "chunk_mesher.h"
+#include "chunk_render_data.h"
+#include "chunk_scheduler.h"
 #include "../render/Shader.h"
 #include "../render/texture.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
 #include <map>
+#include <set>
+#include <deque>
 #include <memory>
 #include <utility>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#define MESH_UPLOAD_BUDGET (2 * 1024 * 1024)   // 每帧 mesh 上传的字节预算（至少上传一个区块）
+#define TERRAIN_ARENA_VERTICES (1 << 21)        // 地形显存池初始容量（顶点，16 MB），不足时自动扩容
+#define CHUNK_ADVANCE_BUDGET_MS 4.0             // 每帧推进区块生命周期的时间预算（毫秒，至少推进一个区块）
+#define RENDER_DISTANCE_MIN 2                   // 渲染距离下限（区块）
+#define RENDER_DISTANCE_MAX 32                  // 渲染距离上限（区块）
+#define RENDER_DISTANCE_DEFAULT 2
+#define UNLOAD_HYSTERESIS 2                     // 加载窗口外再保留的区块圈数，其中的缓存区块不参与淘汰
+#define CHUNK_CACHE_RAM_BUDGET (256u << 20)     // 窗口外缓存区块的 CPU 内存预算（字节）
+#define TERRAIN_VRAM_BUDGET (512u << 20)        // 地形显存池已用空间预算（字节），超出时先归还缓存区块的 mesh
+
+// 存档模式
+// SAVE_REGION : 区域文件保存完整区块（方块 + 光照），再次访问直接读取
+// SAVE_DELTA  : 只保存玩家的编辑记录，读取时由种子重新生成并重放编辑
+enum SaveMode { SAVE_REGION = 0, SAVE_DELTA = 1 };
+
 class Terrain
 {
     private:
-        map<pair<int, int>, unique_ptr<Chunk>> terrainMap;
+        ChunkGrid loadedChunks;             // 以玩家为中心、半径 renderDistance + 1 的环形区块网格（多出的一圈作为边缘区块的邻居）
+        ChunkCache chunkCache;              // 离开加载窗口的区块，超出预算时按 LRU 淘汰
+        int renderDistance = RENDER_DISTANCE_DEFAULT;
+        size_t cacheRamBudget = CHUNK_CACHE_RAM_BUDGET;
+        size_t vramBudget = TERRAIN_VRAM_BUDGET;
         PerlinNoise perlinNoise;
+        WorldGenSettings genSettings;       // 地形生成参数（init_terrain 之后不再修改）
+        ClimateCache climateCache;          // 低频气候噪声瓦片（genSettings.climateCell > 1 时使用，各生成线程共用）
+        SaveMode saveMode = SAVE_REGION;
+        RegionStore regionStore;            // 区域文件存档（按种子区分目录，SAVE_REGION）
+        DeltaStore deltaStore;              // 编辑记录存档（SAVE_DELTA）
+        ChunkGenerator generator;           // 后台生成线程池（须在 perlinNoise 与存档之后声明，先于其析构）
+        ChunkMesher mesher;                 // 后台 mesh 构建线程池
+        ChunkScheduler scheduler;           // 区块生命周期调度：只推进状态可能变化的区块
+        set<pair<int, int>> meshingChunks;  // 已提交构建、结果尚未上传的区块
+        deque<ChunkMeshResult> uploadQueue; // 已构建完成、等待上传的 mesh
+        VertexArena vertexArena;            // 所有分段共用的地形顶点显存池
+        map<pair<int, int>, ChunkRenderData> renderData;    // 已上传 mesh 的区块的显存区间与 GL 缓冲（含缓存中的区块）
+        unsigned int indirectBuffer = 0;    // 不透明分段的间接绘制命令（每帧重写）
+        unsigned int originBuffer = 0;      // 每条绘制的区块原点（逐实例顶点属性，location 5）
+        vector<DrawElementsIndirectCommand> drawCommands;
+        vector<glm::vec3> drawOrigins;
         int chunk_index_x, chunk_index_z;
         Texture blockTexture;
 
+        glm::mat4 revealMatrix = glm::mat4(0.0f);   // 上次检查 hidden 区块可见性时的 VP 矩阵
+
+        // 将后台生成完成的区块并入加载窗口（窗口外的结果直接丢弃），有区块并入时返回 true
+        bool integrate_generated_chunks();
+
+        // 区块放入加载窗口：挂接调度器并唤醒等待它的区块
+        Chunk* adopt_chunk(const pair<int, int>& index, unique_ptr<Chunk> chunk);
+
+        // 按当前中心与渲染距离移动加载窗口，移出的区块放入缓存，新进入渲染范围的区块交给调度器
+        // 窗口没有变化时返回 false
+        bool update_window(int cx, int cz);
+
+        // 为窗口内缺失的区块提交生成（缓存或溢出文件中有的直接取回），只在窗口变化后调用
+        void request_missing_chunks();
+
+        // 按优先级推进调度器队列中的区块（视野内优先，其次离摄像机近的优先），
+        // 超出 CHUNK_ADVANCE_BUDGET_MS 后其余留到下一帧（见 advance_chunk）
+        void advance_chunks(const glm::mat4* vpMatrix);
+
+        // 按生命周期推进一个区块，输入未就绪时登记依赖后返回
+        void advance_chunk(const pair<int, int>& index, const glm::mat4* vpMatrix);
+
+        // 区块是否在渲染范围内（加载窗口最外一圈只作为邻居，不构建 mesh）
+        bool in_render_area(const pair<int, int>& index) const
+        {
+            return abs(index.first - loadedChunks.center_x()) <= renderDistance &&
+                   abs(index.second - loadedChunks.center_z()) <= renderDistance;
+        }
+
+        // 超出预算时按 LRU 淘汰滞回带之外的缓存区块：先归还显存，再释放（或溢出）区块
+        void enforce_memory_budget();
+
+        // 按存档模式保存区块（无存档时把编辑过的区块溢出到磁盘），失败返回 false
+        bool persist_chunk(const pair<int, int>& index, Chunk& chunk);
+
+        // 从缓存或溢出文件取回窗口内缺失的区块，都没有时返回 false
+        bool reload_chunk(const pair<int, int>& index);
+
+        // 查找已加载或已缓存的区块（访问缓存会刷新其 LRU 顺序），不存在时返回 nullptr
+        Chunk* find_chunk(const pair<int, int>& index);
+
+        // 为区块的脏分段拍摄快照并提交后台构建
+        void submit_mesh_job(const pair<int, int>& index, const Chunk* neighbours[4], int priority);
+
+        // 在字节预算内上传已构建完成的 mesh（GL 线程）
+        void upload_meshes(size_t byteBudget);
+
+        // 把区块 sectionMask 中各分段的 CPU mesh 写入其渲染资源（没有时创建，GL 线程）
+        void upload_render_data(const pair<int, int>& index, const Chunk& chunk, unsigned int sectionMask);
+
+        // 归还区块的渲染资源，返回归还的顶点数（GL 线程）
+        unsigned int release_render_data(const pair<int, int>& index);
+
+        const ChunkRenderData* find_render_data(const pair<int, int>& index) const
+        {
+            auto it = renderData.find(index);
+            return it != renderData.end() ? &it->second : nullptr;
+        }
+
+        // 创建间接绘制缓冲并把区块原点属性挂到显存池 VAO 上（GL 线程）
+        void init_draw_buffers();
+
+        // 同步获取区块：未加载时撤回后台任务并在当前线程生成（用于方块查询与编辑）
+        Chunk* get_or_create_chunk(const pair<int, int>& index);
+
+        // 视锥体剔除：AABB 是否与视锥相交（世界空间）
+        static bool is_aabb_visible(const glm::mat4& vp, const glm::vec3& aabbMin, const glm::vec3& aabbMax);
+
+        // 区块是否可见：只测试非空分段的包围盒
         bool is_chunk_visible(const glm::mat4& vp, int cx, int cz) const;
 
     public:
         Terrain(){};
 
-        Terrain(int seed, glm::vec3 position, char const* path)
+        Terrain(int seed, glm::vec3 position, char const* path, SaveMode mode = SAVE_REGION)
         {
-            init_terrain(seed, position, path);
+            init_terrain(seed, position, path, mode);
         }
 
-        void init_terrain(int seed, glm::vec3 position, char const* path)
+        void init_terrain(int seed, glm::vec3 position, char const* path, SaveMode mode = SAVE_REGION)
         {
             perlinNoise.set_seed(seed);
+            genSettings.climate = nullptr;
+            if(genSettings.climateCell > 1)
+            {
+                climateCache.init(&perlinNoise, genSettings.climateCell);
+                genSettings.climate = &climateCache;
+            }
+            saveMode = mode;
+            string saveDir = string(WORLD_SAVE_DIR) + "/world_" + to_string(seed);
+            RegionStore* store = nullptr;
+            DeltaStore* deltas = nullptr;
+            // 存档由其他版本的生成器（或不同的生成参数）写入时不读取也不覆盖，本次游戏不保存
+            uint32_t generatorId = genSettings.generator_id();
+            if(mode == SAVE_DELTA && deltaStore.open(saveDir, generatorId))
+                deltas = &deltaStore;
+            else if(mode == SAVE_REGION && regionStore.open(saveDir, generatorId))
+                store = &regionStore;
+            else
+                std::cout << "Warning: save " << saveDir << " is damaged or was written by a different world generator, "
+                          << "it will not be loaded or saved" << std::endl;
+            generator.start(&perlinNoise, &genSettings, store, deltas);
+            mesher.start();
+            vertexArena.init(TERRAIN_ARENA_VERTICES, ChunkRenderData::quad_index_buffer());
+            chunkCache.open_spill(CHUNK_SPILL_FILE);
+            init_draw_buffers();
             update_terrain(position);
             blockTexture.load_texture(path);
         }
 
+        // 设置地形生成参数，须在 init_terrain 之前调用（生成线程只读这份设置）
+        void set_gen_settings(const WorldGenSettings& settings)
+        {
+            genSettings = settings;
+        }
+
         void update_terrain(const glm::vec3& position, const glm::mat4* vpMatrix = nullptr);
 
         void bind_block_texture(Shader& blockShader)
@@ -46,6 +192,47 @@ class Terrain
             glActiveTexture(GL_TEXTURE0);
         }
 
+        // 设置渲染距离（区块，限制在 [RENDER_DISTANCE_MIN, RENDER_DISTANCE_MAX]），下一次 update_terrain 生效
+        void set_render_distance(int distance)
+        {
+            renderDistance = std::max(RENDER_DISTANCE_MIN, std::min(RENDER_DISTANCE_MAX, distance));
+        }
+
+        int get_render_distance() const { return renderDistance; }
+
+        // 设置淘汰预算（字节）：ramBytes 限制窗口外缓存区块的 CPU 内存，vramBytes 限制显存池已用空间
+        void set_memory_budget(size_t ramBytes, size_t vramBytes)
+        {
+            cacheRamBudget = ramBytes;
+            vramBudget = vramBytes;
+        }
+
+        // 雾效起止距离：在渲染距离的 3/4 处开始，到渲染边界完全融入天空
+        glm::vec2 fog_range() const
+        {
+            return glm::vec2(renderDistance * CHUNK_SIZE * 0.75f, renderDistance * CHUNK_SIZE);
+        }
+
+        // 统计信息
+        size_t loaded_chunk_count() const { return loadedChunks.size() + chunkCache.size(); }
+        size_t cached_chunk_count() const { return chunkCache.size(); }
+        size_t spilled_chunk_count() const { return chunkCache.spilled_count(); }
+        SaveMode get_save_mode() const { return saveMode; }
+        size_t chunk_memory_usage() const;  // 区块 CPU 端数据（字节）
+
+        // 加载窗口内各生命周期阶段的区块数，counts[STAGE_NONE] 为已提交生成、尚未载入的区块数（Requested）
+        void count_chunk_stages(size_t counts[STAGE_COUNT]) const;
+        size_t vertex_memory_usage() const  // 地形显存池容量（字节）
+        {
+            return (size_t)vertexArena.capacity_vertices() * sizeof(TerrainVertex);
+        }
+        size_t vertex_memory_used() const   // 地形显存池已分配（字节）
+        {
+            return (size_t)vertexArena.used_vertices() * sizeof(TerrainVertex);
+        }
+
+        bool greedyMeshing = true;          // 不透明面贪婪合并（关闭则每个可见面一个 quad）
+
         unsigned int drawnVertices = 0;     // 上一帧绘制的顶点数
         unsigned int drawnTriangles = 0;    // 上一帧绘制的三角面片数
 
@@ -59,9 +246,39 @@ class Terrain
 
         bool create_block(glm::ivec3& selectedBlock, BLOCK_TYPE blockType);
 
+        // 是否仍有区块在后台生成或 mesh 尚未上传
+        bool is_loading()
+        {
+            return !generator.is_idle() || !meshingChunks.empty() || scheduler.ready_count() > 0;
+        }
+
+        // 按存档模式保存所有未保存的已加载区块（退出时调用）
+        void save_all();
+
         void clear()
         {
-            terrainMap.clear();
+            generator.stop();
+            mesher.stop();
+            save_all();
+            meshingChunks.clear();
+            uploadQueue.clear();
+            scheduler.clear();
+            ChunkGrid::ChunkList evicted;
+            loadedChunks.clear(evicted);
+            evicted.clear();
+            chunkCache.clear();
+            for(auto& data : renderData)
+                data.second.release(vertexArena);          // 须在显存池销毁之前
+            renderData.clear();
+            chunkCache.close_spill();
+            regionStore.close();
+            deltaStore.close();
+            climateCache.clear();
+            if(indirectBuffer != 0) glDeleteBuffers(1, &indirectBuffer);
+            if(originBuffer != 0) glDeleteBuffers(1, &originBuffer);
+            indirectBuffer = originBuffer = 0;
+            vertexArena.destroy();
+            ChunkRenderData::release_quad_index_buffer();
             blockTexture.clear();
         }
 };
@@ -0,0 +1,66 @@
+#ifndef WORLD_RNG_H
+#define WORLD_RNG_H
+
+#include <cstdint>
+
+// 随机数用途：同一区块不同用途的序列相互独立，新增用途只能追加（改变已有值会改变已有种子的世界）
+enum RngPurpose : uint32_t
+{
+    RNG_PERMUTATION = 0,                                // 柏林噪声置换表（区块坐标取 0, 0）
+    RNG_STONE_OUTCROP = 1,                              // 高地表层露出的石头
+    RNG_TREE = 2,                                       // 树木的个体稀疏化
+};
+
+// 世界生成用的计数器型随机数（SplitMix64）
+//
+// 由 (种子, 区块 x, 区块 z, 用途) 混合出密钥，第 n 个值为 mix(key + n * 黄金比例常数)，不依赖任何全局状态。
+// 按位置取值的 at(n) 与调用顺序无关：区块内以方块下标作为 n，无论由哪个线程、以什么顺序生成，结果都相同。
+class WorldRng
+{
+    private:
+        uint64_t key;
+        uint64_t counter = 0;
+
+    public:
+        static constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+        // SplitMix64 的输出混合函数
+        static constexpr uint64_t mix(uint64_t z)
+        {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        WorldRng(int seed, int chunkX, int chunkZ, uint32_t purpose)
+        {
+            key = mix((uint64_t)(uint32_t)seed + GOLDEN_GAMMA);
+            key = mix(key ^ ((uint64_t)(uint32_t)chunkX << 32 | (uint32_t)chunkZ));
+            key = mix(key ^ ((uint64_t)purpose + GOLDEN_GAMMA));
+        }
+
+        // 第 n 个值（无状态）
+        uint64_t at(uint64_t n) const
+        {
+            return mix(key + (n + 1) * GOLDEN_GAMMA);
+        }
+
+        // 顺序取下一个值
+        uint64_t next()
+        {
+            return at(counter++);
+        }
+
+        // [0, bound) 内的整数（取高 32 位乘法缩放，避免取模偏差集中在低位）
+        static uint32_t below(uint64_t value, uint32_t bound)
+        {
+            return (uint32_t)(((value >> 32) * bound) >> 32);
+        }
+
+        uint32_t next_below(uint32_t bound)
+        {
+            return below(next(), bound);
+        }
+};
+
+#endif
@@ -0,0 +1,307 @@
+#include "worldgen_bench.h"
+#include "chunk.h"
+#include "chunk_generator.h"
+#include "climate_cache.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// 每个区块地表以下的方块是否为洞穴（AIR），按 [区块][i][j][k] 展开
+static double generate_caves(PerlinNoise& perlinNoise, int radius, const WorldGenSettings& settings, vector<bool>& caves)
+{
+    caves.clear();
+    double rowHeight[CHUNK_SIZE];
+    double seconds = 0;
+    for(int cx = -radius; cx < radius; cx++)
+    {
+        for(int cz = -radius; cz < radius; cz++)
+        {
+            // 只计时地形与洞穴两个阶段（树木与光照不受格点间隔影响）
+            auto start = chrono::steady_clock::now();
+            unique_ptr<Chunk> chunk = make_unique<Chunk>();
+            chunk->generate_terrain(perlinNoise, cx, cz, settings);
+            chunk->carve_caves(perlinNoise, cx, cz, settings);
+            seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            for(int i = 0; i < CHUNK_SIZE; i++)
+            {
+                chunk->generate_height_row(perlinNoise, cx*CHUNK_SIZE, cz*CHUNK_SIZE+i, rowHeight);
+                for(int j = 0; j < CHUNK_SIZE; j++)
+                {
+                    int height = max(1, min((int)floor(rowHeight[j]), CHUNK_HEIGHT-2));
+                    for(int k = 1; k < height; k++)
+                        caves.push_back(chunk->get_block_type(j, i, k) == AIR);
+                }
+            }
+        }
+    }
+    return seconds;
+}
+
+void benchmark_cave_lattice(int seed, int radius)
+{
+    const int lattices[][2] = {{1, 2}, {2, 2}, {2, 4}, {4, 4}, {4, 8}, {8, 8}};
+    int chunkCount = 4 * radius * radius;
+
+    PerlinNoise perlinNoise;
+    perlinNoise.set_seed(seed);
+
+    WorldGenSettings reference;
+    reference.set_cave_lattice(1, 1);
+    vector<bool> referenceCaves, caves;
+    double referenceSeconds = generate_caves(perlinNoise, radius, reference, referenceCaves);
+    size_t referenceVolume = 0;
+    for(bool cave : referenceCaves)
+        referenceVolume += cave;
+
+    cout << "seed " << seed << ", " << chunkCount << " chunks, reference cave volume " << referenceVolume << endl;
+    cout << "lattice   chunks/s  ms/chunk  speedup  IoU     mismatch(%)" << endl;
+    cout << std::left << std::fixed << std::setprecision(2)
+         << std::setw(10) << "1x1x1"
+         << std::setw(10) << chunkCount / referenceSeconds
+         << std::setw(10) << referenceSeconds * 1000.0 / chunkCount
+         << std::setw(9) << 1.0
+         << std::setw(8) << std::setprecision(4) << 1.0
+         << std::setprecision(2) << 0.0 << endl;
+
+    for(const int* lattice : lattices)
+    {
+        WorldGenSettings settings;
+        settings.set_cave_lattice(lattice[0], lattice[1]);
+        double seconds = generate_caves(perlinNoise, radius, settings, caves);
+
+        // 地表高度与洞穴无关，两次展开的方块一一对应
+        size_t both = 0, either = 0;
+        for(size_t v = 0; v < caves.size(); v++)
+        {
+            both += referenceCaves[v] && caves[v];
+            either += referenceCaves[v] || caves[v];
+        }
+
+        string name = to_string(settings.caveLatticeXZ) + "x" + to_string(settings.caveLatticeY) + "x" +
+                      to_string(settings.caveLatticeXZ);
+        cout << std::setw(10) << name
+             << std::setw(10) << chunkCount / seconds
+             << std::setw(10) << seconds * 1000.0 / chunkCount
+             << std::setw(9) << referenceSeconds / seconds
+             << std::setw(8) << std::setprecision(4) << (either ? (double)both / either : 1.0)
+             << std::setprecision(2) << (referenceVolume ? 100.0 * (either - both) / referenceVolume : 0.0) << endl;
+    }
+}
+
+size_t peak_resident_bytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;                     // macOS 以字节为单位
+#else
+    return (size_t)usage.ru_maxrss * 1024;              // Linux 以 KB 为单位
+#endif
+#endif
+}
+
+// 打印一个阶段的统计，chunks 为该阶段处理的区块数
+static void report_stage(const char* name, int chunks, double seconds)
+{
+    double columns = (double)chunks * CHUNK_SIZE * CHUNK_SIZE;
+    cout << std::setw(13) << name
+         << std::setw(8) << chunks
+         << std::setw(11) << seconds * 1000.0
+         << std::setw(12) << (seconds > 0 ? chunks / seconds : 0.0)
+         << std::setw(12) << seconds * 1e9 / columns
+         << std::setw(10) << peak_resident_bytes() / (1024.0 * 1024.0) << endl;
+}
+
+uint64_t benchmark_world_generation(int seed, int size, const WorldGenSettings& settings, bool& pipelineMatches)
+{
+    PerlinNoise perlinNoise;
+    perlinNoise.set_seed(seed);
+
+    // 气候缓存与游戏中一样按 climateCell 建立（逐列计算时不需要）
+    WorldGenSettings genSettings = settings;
+    ClimateCache climateCache;
+    if(genSettings.climateCell > 1)
+    {
+        climateCache.init(&perlinNoise, genSettings.climateCell);
+        genSettings.climate = &climateCache;
+    }
+
+    // 区块 (cx, cz) 存于 chunks[(cz+1) * span + (cx+1)]，外围一圈只推进到 STAGE_CARVED
+    int span = size + 2;
+    int outerCount = span * span, innerCount = size * size;
+    vector<unique_ptr<Chunk>> chunks(outerCount);
+    auto slot = [&](int cx, int cz) -> unique_ptr<Chunk>& { return chunks[(cz+1) * span + (cx+1)]; };
+    auto elapsed = [](chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    cout << "seed " << seed << ", " << size << "x" << size << " chunks, cave lattice "
+         << genSettings.caveLatticeXZ << "x" << genSettings.caveLatticeY << ", climate cell " << genSettings.climateCell << endl;
+    cout << "stage        chunks  time(ms)   chunks/s    ns/column   peak(MB)" << endl;
+    cout << std::left << std::fixed << std::setprecision(2);
+
+    auto start = chrono::steady_clock::now();
+    for(int cz = -1; cz <= size; cz++)
+    {
+        for(int cx = -1; cx <= size; cx++)
+        {
+            slot(cx, cz) = make_unique<Chunk>();
+            slot(cx, cz)->generate_terrain(perlinNoise, cx, cz, genSettings);
+        }
+    }
+    report_stage("height noise", outerCount, elapsed(start));
+
+    start = chrono::steady_clock::now();
+    for(int cz = -1; cz <= size; cz++)
+        for(int cx = -1; cx <= size; cx++)
+            slot(cx, cz)->carve_caves(perlinNoise, cx, cz, genSettings);
+    report_stage("caves", outerCount, elapsed(start));
+
+    // 树木：所有区块确定树根，内部区块再种下自己与邻居越界伸入的树木（外围一圈的树根计入本阶段）
+    start = chrono::steady_clock::now();
+    vector<vector<TreeRoot>> roots(outerCount);
+    for(int cz = -1; cz <= size; cz++)
+        for(int cx = -1; cx <= size; cx++)
+            slot(cx, cz)->plan_trees(perlinNoise, cx, cz, roots[(cz+1) * span + (cx+1)]);
+    for(int cz = 0; cz < size; cz++)
+    {
+        for(int cx = 0; cx < size; cx++)
+        {
+            const vector<TreeRoot>* area[9];
+            for(int dz = -1; dz <= 1; dz++)
+                for(int dx = -1; dx <= 1; dx++)
+                    area[(dz+1)*3 + (dx+1)] = &roots[(cz+dz+1) * span + (cx+dx+1)];
+            slot(cx, cz)->decorate(area);
+        }
+    }
+    report_stage("trees", innerCount, elapsed(start));
+
+    // 外围一圈只用于取得树根
+    for(int c = -1; c <= size; c++)
+    {
+        slot(c, -1).reset();
+        slot(c, size).reset();
+        slot(-1, c).reset();
+        slot(size, c).reset();
+    }
+
+    start = chrono::steady_clock::now();
+    for(int cz = 0; cz < size; cz++)
+        for(int cx = 0; cx < size; cx++)
+            slot(cx, cz)->finish_generation(nullptr);
+    report_stage("local light", innerCount, elapsed(start));
+
+    // 按区块 (z, x)、方块 (i, j, k) 的固定顺序做 FNV-1a
+    uint64_t checksum = 0xCBF29CE484222325ull;
+    for(int cz = 0; cz < size; cz++)
+    {
+        for(int cx = 0; cx < size; cx++)
+        {
+            const Chunk& chunk = *slot(cx, cz);
+            for(int i = 0; i < CHUNK_SIZE; i++)
+            {
+                for(int j = 0; j < CHUNK_SIZE; j++)
+                {
+                    for(int k = 0; k < CHUNK_HEIGHT; k++)
+                    {
+                        checksum ^= (uint64_t)chunk.get_block_type(j, i, k);
+                        checksum *= 0x100000001B3ull;
+                    }
+                }
+            }
+        }
+    }
+
+    // 与游戏的生成流水线比较（单个工作线程，generate_now 在本线程推进所需的邻居阶段）
+    ChunkGenerator generator;
+    generator.start(&perlinNoise, &genSettings, nullptr, nullptr, 1);
+    pair<int, int> samples[3] = {{0, 0}, {size/2, size/2}, {size-1, size-1}};
+    int compared = 0;
+    pipelineMatches = true;
+    for(int n = 0; n < 3; n++)
+    {
+        if(n > 0 && samples[n] == samples[n-1])
+            continue;
+        unique_ptr<Chunk> reference = generator.generate_now(samples[n]);
+        const Chunk& chunk = *slot(samples[n].first, samples[n].second);
+        bool same = true;
+        for(int i = 0; i < CHUNK_SIZE && same; i++)
+            for(int j = 0; j < CHUNK_SIZE && same; j++)
+                for(int k = 0; k < CHUNK_HEIGHT && same; k++)
+                    same = chunk.get_block_type(j, i, k) == reference->get_block_type(j, i, k);
+        if(!same)
+        {
+            cout << "pipeline mismatch at chunk (" << samples[n].first << ", " << samples[n].second << ")" << endl;
+            pipelineMatches = false;
+        }
+        compared++;
+    }
+    generator.stop();
+    if(pipelineMatches)
+        cout << "pipeline check: " << compared << " chunks identical to ChunkGenerator" << endl;
+    return checksum;
+}
+
+bool check_light_replay(int seed, const WorldGenSettings& settings)
+{
+    PerlinNoise perlinNoise;
+    perlinNoise.set_seed(seed);
+    const vector<TreeRoot> noRoots;
+    const vector<TreeRoot>* area[9];
+    for(int n = 0; n < 9; n++)
+        area[n] = &noRoots;
+    auto generate = [&](const vector<uint32_t>* replay)
+    {
+        unique_ptr<Chunk> chunk = make_unique<Chunk>();
+        chunk->generate_terrain(perlinNoise, 0, 0, settings);
+        chunk->carve_caves(perlinNoise, 0, 0, settings);
+        chunk->decorate(area);
+        chunk->finish_generation(replay);
+        return chunk;
+    };
+
+    // 实时放置：火把立在区块中心一列的地表上，邻居未加载
+    unique_ptr<Chunk> live = generate(nullptr);
+    int x = CHUNK_SIZE / 2, y = CHUNK_SIZE / 2;
+    int z = live->get_height(x, y) + 1;
+    while(z < CHUNK_HEIGHT - 1 && live->get_block_type(x, y, z) != AIR)
+        z++;
+    Chunk* neighbours[4] = {nullptr, nullptr, nullptr, nullptr};
+    live->set_block(x, y, z, TORCH, neighbours);
+
+    unique_ptr<Chunk> replayed = generate(&live->edits);
+    glm::ivec3 torch(CHUNK_SIZE - 1 - y, x, z);
+    bool same = replayed->get_torch_light(torch) == get_block_luminous(TORCH);
+    for(int i = 0; i < CHUNK_SIZE && same; i++)
+        for(int j = 0; j < CHUNK_SIZE && same; j++)
+            for(int k = 0; k < CHUNK_HEIGHT && same; k++)
+                same = live->get_torch_light({i, j, k}) == replayed->get_torch_light({i, j, k});
+    if(same)
+        cout << "light replay check: torch light " << replayed->get_torch_light(torch)
+             << ", neighbour " << replayed->get_torch_light(torch + glm::ivec3(0, 1, 0)) << " after regenerate" << endl;
+    else
+        cout << "light replay mismatch: torch light " << live->get_torch_light(torch) << " live, "
+             << replayed->get_torch_light(torch) << " after regenerate" << endl;
+    return same;
+}
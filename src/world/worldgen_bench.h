@@ -0,0 +1,32 @@
+#ifndef WORLDGEN_BENCH_H
+#define WORLDGEN_BENCH_H
+
+#include "chunk.h"
+#include <cstddef>
+#include <cstdint>
+
+// 洞穴格点插值基准：以逐方块采样为参照，在同一种子下生成 (2*radius)^2 个区块的地形与洞穴阶段，
+// 比较不同格点间隔的生成速度（chunks/s）与洞穴形状误差。
+// 只比较地表以下的方块（地表高度与洞穴无关），误差以参照洞穴体积为分母：
+//   IoU       两种结果洞穴方块集合的交并比
+//   mismatch  只在其中一种结果里是洞穴的方块数 / 参照洞穴方块数
+// 在单线程上运行，不需要 GL 环境。
+void benchmark_cave_lattice(int seed, int radius);
+
+// 世界生成基准：生成种子 seed 下以原点为角的 size × size 个区块，逐阶段统计
+// chunks/s、ns/column 与该阶段结束时的进程峰值内存（高度噪声、洞穴、树木、区块内光照）。
+// 按阶段依次处理整片区域（先全部生成地形，再全部挖洞穴……），每个阶段的计时只含该阶段；
+// 树木需要邻居的树根，地形与洞穴阶段会多生成外围一圈区块。
+// 返回全部区块方块类型的 FNV-1a 校验和，用于确认性能优化没有改变生成结果。
+// 另取角上与中心的区块交给 ChunkGenerator::generate_now 重新生成（游戏使用的流水线），
+// 逐方块与按阶段生成的结果比较，全部一致时 pipelineMatches 为 true。
+uint64_t benchmark_world_generation(int seed, int size, const WorldGenSettings& settings, bool& pipelineMatches);
+
+// 光照重放检查：在区块 (0, 0)（不种树）地表放置一个火把，再按其编辑记录重新生成同一区块，
+// 逐格比较两者的方块光（重放的发光方块须照亮与实时放置相同的范围），一致时返回 true
+bool check_light_replay(int seed, const WorldGenSettings& settings);
+
+// 进程峰值常驻内存（字节），取不到时返回 0
+size_t peak_resident_bytes();
+
+#endif
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "src/world/worldgen_bench.h"
+
+// 无窗口的世界生成基准，只链接世界生成代码（见 CMakeLists.txt 的 MyMinecraftWorldBench）
+//   --seed <种子>              默认 114514（与游戏相同）
+//   --size <边长>              生成 size × size 个区块，默认 16
+//   --cave-lattice <XZ> <Y>    与游戏的同名参数相同
+//   --climate-cell <间隔>      同上
+//   --checksum-file <路径>     把校验和写入文件
+//   --expect <校验和>          与给定的十六进制校验和比较，不一致时返回 1
+// 抽样区块与 ChunkGenerator 的生成结果不一致、或重放的火把光照与实时放置不同时同样返回 1
+int main(int argc, char* argv[])
+{
+    int seed = 114514;
+    int size = 16;
+    const char* checksumFile = nullptr;
+    const char* expected = nullptr;
+    WorldGenSettings genSettings;
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            size = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--cave-lattice") == 0 && i + 2 < argc)
+        {
+            genSettings.set_cave_lattice(atoi(argv[i + 1]), atoi(argv[i + 2]));
+            i += 2;
+        }
+        else if(strcmp(argv[i], "--climate-cell") == 0 && i + 1 < argc)
+            genSettings.set_climate_cell(atoi(argv[++i]));
+        else if(strcmp(argv[i], "--checksum-file") == 0 && i + 1 < argc)
+            checksumFile = argv[++i];
+        else if(strcmp(argv[i], "--expect") == 0 && i + 1 < argc)
+            expected = argv[++i];
+        else
+        {
+            std::cerr << "unknown argument: " << argv[i] << std::endl;
+            return 2;
+        }
+    }
+    if(size < 1)
+    {
+        std::cerr << "--size must be positive" << std::endl;
+        return 2;
+    }
+
+    bool pipelineMatches;
+    uint64_t checksum = benchmark_world_generation(seed, size, genSettings, pipelineMatches);
+    char text[17];
+    snprintf(text, sizeof(text), "%016llx", (unsigned long long)checksum);
+    std::cout << "block checksum " << text << std::endl;
+
+    if(checksumFile)
+    {
+        std::ofstream out(checksumFile);
+        out << text << std::endl;
+        if(!out)
+        {
+            std::cerr << "cannot write " << checksumFile << std::endl;
+            return 2;
+        }
+    }
+    if(expected && strtoull(expected, nullptr, 16) != checksum)
+    {
+        std::cerr << "checksum mismatch, expected " << expected << std::endl;
+        return 1;
+    }
+    bool lightMatches = check_light_replay(seed, genSettings);
+    return pipelineMatches && lightMatches ? 0 : 1;
+}